@@ -51,7 +51,7 @@ LOG_MODULE_REGISTER(il0323, CONFIG_DISPLAY_LOG_LEVEL);
 #define IL0323_PANEL_LAST_GATE (EPD_PANEL_HEIGHT - 1)
 #define IL0323_PANEL_FIRST_PAGE 0U
 #define IL0323_PANEL_LAST_PAGE (IL0323_NUMOF_PAGES - 1)
-#define IL0323_BUFFER_SIZE 1280
+#define IL0323_BUFFER_SIZE (IL0323_NUMOF_PAGES * EPD_PANEL_HEIGHT)
 
 struct il0323_data {
     const struct device *reset;
@@ -66,6 +66,7 @@ struct il0323_data {
 
 static uint8_t il0323_pwr[] = DT_INST_PROP(0, pwr);
 
+/* Contents of the whole panel as last written, in the same layout as the controller's memory. */
 static uint8_t last_buffer[IL0323_BUFFER_SIZE];
 static bool blanking_on = true;
 
@@ -91,6 +92,41 @@ static inline int il0323_write_cmd(struct il0323_data *driver, uint8_t cmd, uint
     return 0;
 }
 
+static inline int il0323_write_data(struct il0323_data *driver, const uint8_t *data, size_t len) {
+    struct spi_buf buf = {.buf = (uint8_t *)data, .len = len};
+    struct spi_buf_set buf_set = {.buffers = &buf, .count = 1};
+
+    gpio_pin_set(driver->dc, IL0323_DC_PIN, 0);
+    if (spi_write(driver->spi_dev, &driver->spi_config, &buf_set)) {
+        return -EIO;
+    }
+
+    return 0;
+}
+
+/*
+ * Write a window of rows after a data transfer command. The controller keeps its data pointer
+ * across chip select changes, so rows which aren't contiguous in memory are sent one at a time.
+ */
+static int il0323_write_rows(struct il0323_data *driver, uint8_t cmd, const uint8_t *data,
+                             size_t row_len, size_t pitch, uint16_t rows) {
+    if (il0323_write_cmd(driver, cmd, NULL, 0)) {
+        return -EIO;
+    }
+
+    if (row_len == pitch) {
+        return il0323_write_data(driver, data, row_len * rows);
+    }
+
+    for (uint16_t i = 0; i < rows; i++) {
+        if (il0323_write_data(driver, &data[i * pitch], row_len)) {
+            return -EIO;
+        }
+    }
+
+    return 0;
+}
+
 static inline void il0323_busy_wait(struct il0323_data *driver) {
     int pin = gpio_pin_get(driver->busy, IL0323_BUSY_PIN);
 
@@ -115,39 +151,53 @@ static int il0323_update_display(const struct device *dev) {
     return 0;
 }
 
-static int il0323_write(const struct device *dev, const uint16_t x, const uint16_t y,
-                        const struct display_buffer_descriptor *desc, const void *buf) {
+static void il0323_store_rows(uint8_t *dst, const uint8_t *src, size_t row_len, size_t pitch,
+                              uint16_t rows) {
+    for (uint16_t i = 0; i < rows; i++) {
+        memcpy(&dst[i * IL0323_NUMOF_PAGES], &src[i * pitch], row_len);
+    }
+}
+
+static int il0323_write_full(const struct device *dev, uint8_t *dst, const uint8_t *src,
+                             size_t row_len, size_t pitch, uint16_t rows) {
     struct il0323_data *driver = dev->data;
-    uint16_t x_end_idx = x + desc->width - 1;
-    uint16_t y_end_idx = y + desc->height - 1;
-    uint8_t ptl[IL0323_PTL_REG_LENGTH] = {0};
-    size_t buf_len;
 
-    LOG_DBG("x %u, y %u, height %u, width %u, pitch %u", x, y, desc->height, desc->width,
-            desc->pitch);
+    /* Outside of partial mode, the controller expects the whole previous and new frames */
+    if (il0323_write_rows(driver, IL0323_CMD_DTM1, last_buffer, IL0323_NUMOF_PAGES,
+                          IL0323_NUMOF_PAGES, EPD_PANEL_HEIGHT)) {
+        return -EIO;
+    }
 
-    buf_len = MIN(desc->buf_size, desc->height * desc->width / IL0323_PIXELS_PER_BYTE);
-    __ASSERT(desc->width <= desc->pitch, "Pitch is smaller then width");
-    __ASSERT(buf != NULL, "Buffer is not available");
-    __ASSERT(buf_len != 0U, "Buffer of length zero");
-    __ASSERT(!(desc->width % IL0323_PIXELS_PER_BYTE), "Buffer width not multiple of %d",
-             IL0323_PIXELS_PER_BYTE);
+    il0323_store_rows(dst, src, row_len, pitch, rows);
 
-    LOG_DBG("buf_len %d", buf_len);
-    if ((y_end_idx > (EPD_PANEL_HEIGHT - 1)) || (x_end_idx > (EPD_PANEL_WIDTH - 1))) {
-        LOG_ERR("Position out of bounds");
-        return -EINVAL;
+    if (il0323_write_rows(driver, IL0323_CMD_DTM2, last_buffer, IL0323_NUMOF_PAGES,
+                          IL0323_NUMOF_PAGES, EPD_PANEL_HEIGHT)) {
+        return -EIO;
+    }
+
+    if (blanking_on == false) {
+        if (il0323_update_display(dev)) {
+            return -EIO;
+        }
     }
 
+    return 0;
+}
+
+static int il0323_write_partial(const struct device *dev, const uint16_t x, const uint16_t y,
+                                uint8_t *dst, const uint8_t *src, size_t row_len, size_t pitch,
+                                uint16_t rows) {
+    struct il0323_data *driver = dev->data;
+    uint8_t ptl[IL0323_PTL_REG_LENGTH] = {0};
+
     /* Setup Partial Window and enable Partial Mode */
     ptl[IL0323_PTL_HRST_IDX] = x;
-    ptl[IL0323_PTL_HRED_IDX] = x_end_idx;
+    ptl[IL0323_PTL_HRED_IDX] = x + row_len * IL0323_PIXELS_PER_BYTE - 1;
     ptl[IL0323_PTL_VRST_IDX] = y;
-    ptl[IL0323_PTL_VRED_IDX] = y_end_idx;
+    ptl[IL0323_PTL_VRED_IDX] = y + rows - 1;
     ptl[sizeof(ptl) - 1] = IL0323_PTL_PT_SCAN;
     LOG_HEXDUMP_DBG(ptl, sizeof(ptl), "ptl");
 
-    il0323_busy_wait(driver);
     if (il0323_write_cmd(driver, IL0323_CMD_PIN, NULL, 0)) {
         return -EIO;
     }
@@ -156,15 +206,16 @@ static int il0323_write(const struct device *dev, const uint16_t x, const uint16
         return -EIO;
     }
 
-    if (il0323_write_cmd(driver, IL0323_CMD_DTM1, last_buffer, IL0323_BUFFER_SIZE)) {
+    /* Only the window's bytes of the previous and new frames are sent */
+    if (il0323_write_rows(driver, IL0323_CMD_DTM1, dst, row_len, IL0323_NUMOF_PAGES, rows)) {
         return -EIO;
     }
 
-    if (il0323_write_cmd(driver, IL0323_CMD_DTM2, (uint8_t *)buf, buf_len)) {
+    if (il0323_write_rows(driver, IL0323_CMD_DTM2, src, row_len, pitch, rows)) {
         return -EIO;
     }
 
-    memcpy(last_buffer, (uint8_t *)buf, IL0323_BUFFER_SIZE);
+    il0323_store_rows(dst, src, row_len, pitch, rows);
 
     /* Update partial window and disable Partial Mode */
     if (blanking_on == false) {
@@ -180,6 +231,72 @@ static int il0323_write(const struct device *dev, const uint16_t x, const uint16
     return 0;
 }
 
+static int il0323_write(const struct device *dev, const uint16_t x, const uint16_t y,
+                        const struct display_buffer_descriptor *desc, const void *buf) {
+    struct il0323_data *driver = dev->data;
+    uint16_t x_end_idx = x + desc->width - 1;
+    uint16_t y_end_idx = y + desc->height - 1;
+    size_t row_len = desc->width / IL0323_PIXELS_PER_BYTE;
+    size_t pitch = desc->pitch / IL0323_PIXELS_PER_BYTE;
+    const uint8_t *src = buf;
+    uint8_t *dst;
+    uint16_t first, last, rows;
+
+    LOG_DBG("x %u, y %u, height %u, width %u, pitch %u", x, y, desc->height, desc->width,
+            desc->pitch);
+
+    __ASSERT(desc->width <= desc->pitch, "Pitch is smaller then width");
+    __ASSERT(buf != NULL, "Buffer is not available");
+    __ASSERT(desc->buf_size >= (desc->height - 1) * pitch + row_len, "Buffer is too small");
+    __ASSERT(!(desc->width % IL0323_PIXELS_PER_BYTE), "Buffer width not multiple of %d",
+             IL0323_PIXELS_PER_BYTE);
+    __ASSERT(!(x % IL0323_PIXELS_PER_BYTE), "X position not multiple of %d",
+             IL0323_PIXELS_PER_BYTE);
+
+    if ((y_end_idx > (EPD_PANEL_HEIGHT - 1)) || (x_end_idx > (EPD_PANEL_WIDTH - 1))) {
+        LOG_ERR("Position out of bounds");
+        return -EINVAL;
+    }
+
+    dst = &last_buffer[y * IL0323_NUMOF_PAGES + x / IL0323_PIXELS_PER_BYTE];
+
+    /* Shrink the window to the rows which differ from the previous frame */
+    for (first = 0; first < desc->height; first++) {
+        if (memcmp(&dst[first * IL0323_NUMOF_PAGES], &src[first * pitch], row_len)) {
+            break;
+        }
+    }
+
+    if (first == desc->height) {
+        LOG_DBG("Window unchanged");
+        return 0;
+    }
+
+    for (last = desc->height - 1; last > first; last--) {
+        if (memcmp(&dst[last * IL0323_NUMOF_PAGES], &src[last * pitch], row_len)) {
+            break;
+        }
+    }
+
+    rows = last - first + 1;
+    dst += first * IL0323_NUMOF_PAGES;
+    src += first * pitch;
+
+    il0323_busy_wait(driver);
+
+    /*
+     * A partial refresh only drives the changed window, but leaves more ghosting. Large changes
+     * refresh the whole panel instead, which then needs the whole frame.
+     */
+    if (rows * desc->width * 100U >=
+        EPD_PANEL_WIDTH * EPD_PANEL_HEIGHT * CONFIG_IL0323_FULL_REFRESH_PERCENT) {
+        LOG_DBG("Full refresh of %u rows", rows);
+        return il0323_write_full(dev, dst, src, row_len, pitch, rows);
+    }
+
+    return il0323_write_partial(dev, x, y + first, dst, src, row_len, pitch, rows);
+}
+
 static int il0323_read(const struct device *dev, const uint16_t x, const uint16_t y,
                        const struct display_buffer_descriptor *desc, void *buf) {
     LOG_ERR("not supported");
@@ -187,25 +304,20 @@ static int il0323_read(const struct device *dev, const uint16_t x, const uint16_
 }
 
 static int il0323_clear_and_write_buffer(const struct device *dev, uint8_t pattern, bool update) {
-    struct display_buffer_descriptor desc = {
-        .buf_size = IL0323_NUMOF_PAGES,
-        .width = EPD_PANEL_WIDTH,
-        .height = 1,
-        .pitch = EPD_PANEL_WIDTH,
-    };
-    uint8_t *line;
+    struct il0323_data *driver = dev->data;
 
-    line = k_malloc(IL0323_NUMOF_PAGES);
-    if (line == NULL) {
-        return -ENOMEM;
+    /* Send the previous and cleared frames to the whole panel in one transfer each */
+    if (il0323_write_rows(driver, IL0323_CMD_DTM1, last_buffer, IL0323_BUFFER_SIZE,
+                          IL0323_BUFFER_SIZE, 1)) {
+        return -EIO;
     }
 
-    memset(line, pattern, IL0323_NUMOF_PAGES);
-    for (int i = 0; i < EPD_PANEL_HEIGHT; i++) {
-        il0323_write(dev, 0, i, &desc, line);
-    }
+    memset(last_buffer, pattern, sizeof(last_buffer));
 
-    k_free(line);
+    if (il0323_write_rows(driver, IL0323_CMD_DTM2, last_buffer, IL0323_BUFFER_SIZE,
+                          IL0323_BUFFER_SIZE, 1)) {
+        return -EIO;
+    }
 
     if (update == true) {
         if (il0323_update_display(dev)) {
@@ -41,6 +41,8 @@ struct reg_595_drv_data {
     struct k_sem lock;
 
     uint32_t gpio_cache;
+    /* The latches power up in an unknown state, so gpio_cache is only valid after a write. */
+    bool cache_valid;
 };
 
 static int reg_595_write_registers(const struct device *dev, uint32_t value) {
@@ -69,6 +71,7 @@ static int reg_595_write_registers(const struct device *dev, uint32_t value) {
     }
 
     drv_data->gpio_cache = value;
+    drv_data->cache_valid = true;
     return 0;
 }
 
@@ -126,7 +129,10 @@ static int reg_595_port_set_masked_raw(const struct device *dev, uint32_t mask,
     buf = drv_data->gpio_cache;
     buf = (buf & ~mask) | (mask & value);
 
-    ret = reg_595_write_registers(dev, buf);
+    /* Every write shifts out the whole chain, so skip it if no outputs changed. */
+    ret = (!drv_data->cache_valid || buf != drv_data->gpio_cache)
+              ? reg_595_write_registers(dev, buf)
+              : 0;
 
     k_sem_give(&drv_data->lock);
     return ret;
@@ -155,7 +161,9 @@ static int reg_595_port_toggle_bits(const struct device *dev, uint32_t mask) {
     buf = drv_data->gpio_cache;
     buf ^= mask;
 
-    ret = reg_595_write_registers(dev, buf);
+    ret = (!drv_data->cache_valid || buf != drv_data->gpio_cache)
+              ? reg_595_write_registers(dev, buf)
+              : 0;
 
     k_sem_give(&drv_data->lock);
     return ret;
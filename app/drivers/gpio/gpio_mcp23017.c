@@ -18,6 +18,7 @@
 #include <sys/byteorder.h>
 #include <drivers/gpio.h>
 #include <drivers/i2c.h>
+#include <gpio/gpio_utils.h>
 
 #include "gpio_mcp23017.h"
 
@@ -90,6 +91,95 @@ static int write_port_regs(const struct device *dev, uint8_t reg, uint16_t value
     return 0;
 }
 
+/**
+ * @brief Read only the ports of a register pair which contain pins in mask.
+ *
+ * Reading a single port halves the I2C transfer, which matters when the register is read
+ * repeatedly, such as the GPIO register during a key matrix scan.
+ *
+ * @param dev Device struct of the MCP23017.
+ * @param reg Register to read (the PORTA of the pair of registers).
+ * @param mask Pins which must be read. Bits for ports which are not read are set to zero.
+ * @param buf Buffer to read data into.
+ *
+ * @return 0 if successful, failed otherwise.
+ */
+static int read_port_regs_masked(const struct device *dev, uint8_t reg, uint16_t mask,
+                                 uint16_t *buf) {
+    const struct mcp23017_config *const config = dev->config;
+    struct mcp23017_drv_data *const drv_data = (struct mcp23017_drv_data *const)dev->data;
+    uint8_t port_data;
+    int ret;
+
+    if ((mask & MCP23017_PORTA_PINS) != 0U && (mask & MCP23017_PORTB_PINS) != 0U) {
+        return read_port_regs(dev, reg, buf);
+    }
+
+    if (mask == 0U) {
+        *buf = 0;
+        return 0;
+    }
+
+    if ((mask & MCP23017_PORTB_PINS) != 0U) {
+        reg += 1;
+    }
+
+    ret = i2c_reg_read_byte(drv_data->i2c, config->slave, reg, &port_data);
+    if (ret) {
+        LOG_DBG("i2c_reg_read_byte FAIL %d\n", ret);
+        return ret;
+    }
+
+    *buf = (mask & MCP23017_PORTB_PINS) != 0U ? (uint16_t)port_data << 8 : port_data;
+
+    LOG_DBG("MCP23017: Read: REG[0x%X] = 0x%X", reg, port_data);
+
+    return 0;
+}
+
+/**
+ * @brief Write only the ports of a register pair which contain pins in mask.
+ *
+ * @param dev Device struct of the MCP23017.
+ * @param reg Register to write into (the PORTA of the pair of registers).
+ * @param mask Pins which changed. Ports with no pins in mask are not written.
+ * @param value Value of both ports.
+ *
+ * @return 0 if successful, failed otherwise.
+ */
+static int write_port_regs_masked(const struct device *dev, uint8_t reg, uint16_t mask,
+                                  uint16_t value) {
+    const struct mcp23017_config *const config = dev->config;
+    struct mcp23017_drv_data *const drv_data = (struct mcp23017_drv_data *const)dev->data;
+    uint8_t port_data;
+    int ret;
+
+    if ((mask & MCP23017_PORTA_PINS) != 0U && (mask & MCP23017_PORTB_PINS) != 0U) {
+        return write_port_regs(dev, reg, value);
+    }
+
+    if (mask == 0U) {
+        return 0;
+    }
+
+    if ((mask & MCP23017_PORTB_PINS) != 0U) {
+        reg += 1;
+        port_data = value >> 8;
+    } else {
+        port_data = value & 0xFF;
+    }
+
+    LOG_DBG("MCP23017: Write: REG[0x%X] = 0x%X", reg, port_data);
+
+    ret = i2c_reg_write_byte(drv_data->i2c, config->slave, reg, port_data);
+    if (ret) {
+        LOG_DBG("i2c_reg_write_byte FAIL %d\n", ret);
+        return ret;
+    }
+
+    return 0;
+}
+
 /**
  * @brief Setup the pin direction (input or output)
  *
@@ -116,6 +206,8 @@ static int setup_pin_dir(const struct device *dev, uint32_t pin, int flags) {
         *dir |= BIT(pin);
     }
 
+    WRITE_BIT(drv_data->input_pins, pin, (flags & GPIO_INPUT) != 0U);
+
     ret = write_port_regs(dev, REG_GPIO_PORTA, *output);
     if (ret != 0) {
         return ret;
@@ -203,12 +295,16 @@ static int mcp23017_port_get_raw(const struct device *dev, uint32_t *value) {
 
     k_sem_take(&drv_data->lock, K_FOREVER);
 
-    ret = read_port_regs(dev, REG_GPIO_PORTA, &buf);
+    /*
+     * Only read the ports which have pins configured as inputs. Output pins read back the value
+     * of the output latch, which is already in the cache.
+     */
+    ret = read_port_regs_masked(dev, REG_GPIO_PORTA, drv_data->input_pins, &buf);
     if (ret != 0) {
         goto done;
     }
 
-    *value = buf;
+    *value = (buf & drv_data->input_pins) | (drv_data->reg_cache.gpio & ~drv_data->input_pins);
 
 done:
     k_sem_give(&drv_data->lock);
@@ -230,7 +326,8 @@ static int mcp23017_port_set_masked_raw(const struct device *dev, uint32_t mask,
     buf = drv_data->reg_cache.gpio;
     buf = (buf & ~mask) | (mask & value);
 
-    ret = write_port_regs(dev, REG_GPIO_PORTA, buf);
+    /* Skip the bus transfer for ports whose outputs did not change. */
+    ret = write_port_regs_masked(dev, REG_GPIO_PORTA, buf ^ drv_data->reg_cache.gpio, buf);
     if (ret == 0) {
         drv_data->reg_cache.gpio = buf;
     }
@@ -263,7 +360,7 @@ static int mcp23017_port_toggle_bits(const struct device *dev, uint32_t mask) {
     buf = drv_data->reg_cache.gpio;
     buf ^= mask;
 
-    ret = write_port_regs(dev, REG_GPIO_PORTA, buf);
+    ret = write_port_regs_masked(dev, REG_GPIO_PORTA, mask, buf);
     if (ret == 0) {
         drv_data->reg_cache.gpio = buf;
     }
@@ -275,7 +372,225 @@ static int mcp23017_port_toggle_bits(const struct device *dev, uint32_t mask) {
 
 static int mcp23017_pin_interrupt_configure(const struct device *dev, gpio_pin_t pin,
                                             enum gpio_int_mode mode, enum gpio_int_trig trig) {
-    return -ENOTSUP;
+    const struct mcp23017_config *const config = dev->config;
+    struct mcp23017_drv_data *const drv_data = (struct mcp23017_drv_data *const)dev->data;
+    uint16_t gpinten, intcon, defval;
+    int ret;
+
+    if (mode != GPIO_INT_MODE_DISABLED && config->int_gpios_len == 0) {
+        return -ENOTSUP;
+    }
+
+    if (mode != GPIO_INT_MODE_DISABLED && mode != GPIO_INT_MODE_LEVEL &&
+        mode != GPIO_INT_MODE_EDGE) {
+        return -ENOTSUP;
+    }
+
+    if (mode == GPIO_INT_MODE_LEVEL && trig == GPIO_INT_TRIG_BOTH) {
+        return -ENOTSUP;
+    }
+
+    /* Can't do I2C bus operations from an ISR */
+    if (k_is_in_isr()) {
+        return -EWOULDBLOCK;
+    }
+
+    k_sem_take(&drv_data->lock, K_FOREVER);
+
+    gpinten = drv_data->reg_cache.gpinten;
+    intcon = drv_data->reg_cache.intcon;
+    defval = drv_data->reg_cache.defval;
+
+    switch (mode) {
+    case GPIO_INT_MODE_DISABLED:
+        WRITE_BIT(gpinten, pin, 0);
+        break;
+
+    case GPIO_INT_MODE_LEVEL:
+        /* Compare against DEFVAL, which interrupts while the pin differs from it. */
+        WRITE_BIT(gpinten, pin, 1);
+        WRITE_BIT(intcon, pin, 1);
+        WRITE_BIT(defval, pin, trig == GPIO_INT_TRIG_LOW);
+        break;
+
+    case GPIO_INT_MODE_EDGE:
+        /*
+         * The chip only supports interrupt-on-change. Single edges are filtered using the
+         * captured pin value when the interrupt is handled.
+         */
+        WRITE_BIT(gpinten, pin, 1);
+        WRITE_BIT(intcon, pin, 0);
+        break;
+    }
+
+    WRITE_BIT(drv_data->int_rising, pin, mode == GPIO_INT_MODE_EDGE && trig == GPIO_INT_TRIG_HIGH);
+    WRITE_BIT(drv_data->int_falling, pin, mode == GPIO_INT_MODE_EDGE && trig == GPIO_INT_TRIG_LOW);
+
+    /* Configure the comparison before enabling the interrupt so it can't fire spuriously. */
+    ret = write_port_regs_masked(dev, REG_DEFVAL_PORTA, defval ^ drv_data->reg_cache.defval,
+                                 defval);
+    if (ret != 0) {
+        goto done;
+    }
+    drv_data->reg_cache.defval = defval;
+
+    ret = write_port_regs_masked(dev, REG_INTCON_PORTA, intcon ^ drv_data->reg_cache.intcon,
+                                 intcon);
+    if (ret != 0) {
+        goto done;
+    }
+    drv_data->reg_cache.intcon = intcon;
+
+    ret = write_port_regs_masked(dev, REG_GPINTEN_PORTA, gpinten ^ drv_data->reg_cache.gpinten,
+                                 gpinten);
+    if (ret != 0) {
+        goto done;
+    }
+    drv_data->reg_cache.gpinten = gpinten;
+
+done:
+    k_sem_give(&drv_data->lock);
+    return ret;
+}
+
+static int mcp23017_manage_callback(const struct device *dev, struct gpio_callback *callback,
+                                    bool set) {
+    struct mcp23017_drv_data *const drv_data = (struct mcp23017_drv_data *const)dev->data;
+
+    return gpio_manage_callback(&drv_data->callbacks, callback, set);
+}
+
+static void mcp23017_int_work_handler(struct k_work *work) {
+    struct mcp23017_drv_data *const drv_data =
+        CONTAINER_OF(work, struct mcp23017_drv_data, int_work);
+    const struct device *dev = drv_data->dev;
+    const struct mcp23017_config *const config = dev->config;
+    uint8_t buf[4];
+    uint16_t pins = 0;
+    int ret;
+
+    k_sem_take(&drv_data->lock, K_FOREVER);
+
+    /*
+     * INTF and INTCAP are adjacent, so one transfer reads which pins interrupted and their values
+     * at the time of the interrupt. Reading INTCAP also clears the interrupt.
+     */
+    ret = i2c_burst_read(drv_data->i2c, config->slave, REG_INTF_PORTA, buf, sizeof(buf));
+    if (ret == 0) {
+        const uint16_t intcap = sys_get_le16(&buf[2]);
+
+        drv_data->reg_cache.intf = sys_get_le16(&buf[0]);
+        drv_data->reg_cache.intcap = intcap;
+
+        pins = drv_data->reg_cache.intf & drv_data->reg_cache.gpinten;
+        pins &= ~(drv_data->int_rising & ~intcap);
+        pins &= ~(drv_data->int_falling & intcap);
+    } else {
+        LOG_ERR("MCP23017: error reading interrupt flags (%d)", ret);
+    }
+
+    k_sem_give(&drv_data->lock);
+
+    if (pins != 0U) {
+        gpio_fire_callbacks(&drv_data->callbacks, dev, pins);
+    }
+
+    /* Level interrupts re-trigger here if a pin is still active. */
+    for (int i = 0; i < config->int_gpios_len; i++) {
+        gpio_pin_interrupt_configure_dt(&config->int_gpios[i], GPIO_INT_LEVEL_ACTIVE);
+    }
+}
+
+static void mcp23017_int_gpio_callback(const struct device *port, struct gpio_callback *cb,
+                                       gpio_port_pins_t pins) {
+    struct mcp23017_int_callback *int_cb = CONTAINER_OF(cb, struct mcp23017_int_callback, callback);
+    const struct mcp23017_config *const config = int_cb->dev->config;
+    struct mcp23017_drv_data *const drv_data =
+        (struct mcp23017_drv_data *const)int_cb->dev->data;
+
+    /*
+     * The interrupt stays asserted until the flags are read over I2C, which can't be done from
+     * an ISR. Mask it until the work item has cleared it.
+     */
+    for (int i = 0; i < config->int_gpios_len; i++) {
+        gpio_pin_interrupt_configure_dt(&config->int_gpios[i], GPIO_INT_DISABLE);
+    }
+
+    k_work_submit(&drv_data->int_work);
+}
+
+/**
+ * @brief Set up the host GPIOs connected to the INTA/INTB outputs.
+ *
+ * With a single interrupt GPIO, the outputs are mirrored so either port can interrupt.
+ *
+ * @param dev Device struct
+ * @return 0 if successful, failed otherwise.
+ */
+static int mcp23017_init_interrupts(const struct device *dev) {
+    const struct mcp23017_config *const config = dev->config;
+    struct mcp23017_drv_data *const drv_data = (struct mcp23017_drv_data *const)dev->data;
+    int ret;
+
+    if (config->int_gpios_len == 0) {
+        return 0;
+    }
+
+    /* INTA and INTB are active low push-pull outputs by default. */
+    if (config->int_gpios_len == 1) {
+        drv_data->reg_cache.iocon |= IOCON_MIRROR;
+    } else {
+        drv_data->reg_cache.iocon &= ~IOCON_MIRROR;
+    }
+
+    ret = i2c_reg_write_byte(drv_data->i2c, config->slave, REG_IOCON,
+                             (uint8_t)drv_data->reg_cache.iocon);
+    if (ret != 0) {
+        LOG_ERR("MCP23017: error configuring IOCON (%d)", ret);
+        return ret;
+    }
+
+    k_work_init(&drv_data->int_work, mcp23017_int_work_handler);
+
+    for (int i = 0; i < config->int_gpios_len; i++) {
+        const struct gpio_dt_spec *gpio = &config->int_gpios[i];
+        struct mcp23017_int_callback *int_cb = &drv_data->int_callbacks[i];
+
+        if (!device_is_ready(gpio->port)) {
+            LOG_ERR("Interrupt GPIO port %s is not ready", gpio->port->name);
+            return -ENODEV;
+        }
+
+        /* The level interrupt is armed on the active level, which is low for INTA/INTB. */
+        if ((gpio->dt_flags & GPIO_ACTIVE_LOW) == 0U) {
+            LOG_WRN("Interrupt pin %u on %s should be GPIO_ACTIVE_LOW", gpio->pin,
+                    gpio->port->name);
+        }
+
+        ret = gpio_pin_configure_dt(gpio, GPIO_INPUT);
+        if (ret != 0) {
+            LOG_ERR("Unable to configure interrupt pin %u on %s", gpio->pin, gpio->port->name);
+            return ret;
+        }
+
+        int_cb->dev = dev;
+        gpio_init_callback(&int_cb->callback, mcp23017_int_gpio_callback, BIT(gpio->pin));
+
+        ret = gpio_add_callback(gpio->port, &int_cb->callback);
+        if (ret != 0) {
+            LOG_ERR("Error adding the interrupt callback to %s", gpio->port->name);
+            return ret;
+        }
+
+        ret = gpio_pin_interrupt_configure_dt(gpio, GPIO_INT_LEVEL_ACTIVE);
+        if (ret != 0) {
+            LOG_ERR("Unable to configure interrupt for pin %u on %s", gpio->pin,
+                    gpio->port->name);
+            return ret;
+        }
+    }
+
+    return 0;
 }
 
 static const struct gpio_driver_api api_table = {
@@ -286,6 +601,7 @@ static const struct gpio_driver_api api_table = {
     .port_clear_bits_raw = mcp23017_port_clear_bits_raw,
     .port_toggle_bits = mcp23017_port_toggle_bits,
     .pin_interrupt_configure = mcp23017_pin_interrupt_configure,
+    .manage_callback = mcp23017_manage_callback,
 };
 
 /**
@@ -306,14 +622,29 @@ static int mcp23017_init(const struct device *dev) {
 
     k_sem_init(&drv_data->lock, 1, 1);
 
-    return 0;
+    drv_data->dev = dev;
+
+    return mcp23017_init_interrupts(dev);
 }
 
+#define MCP23017_INT_GPIO(node_id, prop, idx) GPIO_DT_SPEC_GET_BY_IDX(node_id, prop, idx),
+
 #define MCP23017_INIT(inst)                                                                        \
+    BUILD_ASSERT(DT_INST_PROP_LEN_OR(inst, int_gpios, 0) <= MCP23017_INT_GPIOS_MAX,                \
+                 "MCP23017 has at most two interrupt outputs");                                    \
+                                                                                                   \
+    COND_CODE_1(DT_INST_NODE_HAS_PROP(inst, int_gpios),                                            \
+                (static const struct gpio_dt_spec mcp23017_##inst##_int_gpios[] = {                \
+                     DT_INST_FOREACH_PROP_ELEM(inst, int_gpios, MCP23017_INT_GPIO)};),             \
+                ())                                                                                \
+                                                                                                   \
     static struct mcp23017_config mcp23017_##inst##_config = {                                     \
         .i2c_dev_name = DT_INST_BUS_LABEL(inst),                                                   \
         .slave = DT_INST_REG_ADDR(inst),                                                           \
-                                                                                                   \
+        COND_CODE_1(DT_INST_NODE_HAS_PROP(inst, int_gpios),                                        \
+                    (.int_gpios = mcp23017_##inst##_int_gpios,                                     \
+                     .int_gpios_len = ARRAY_SIZE(mcp23017_##inst##_int_gpios), ),                  \
+                    ())                                                                            \
     };                                                                                             \
                                                                                                    \
     static struct mcp23017_drv_data mcp23017_##inst##_drvdata = {                                  \
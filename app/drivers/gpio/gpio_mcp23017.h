@@ -31,6 +31,7 @@ extern "C" {
 #define REG_DEFVAL_PORTB 0x07
 #define REG_INTCON_PORTA 0x08
 #define REG_INTCON_PORTB 0x09
+#define REG_IOCON 0x0A
 #define REG_GPPU_PORTA 0x0C
 #define REG_GPPU_PORTB 0x0D
 #define REG_INTF_PORTA 0x0E
@@ -45,6 +46,18 @@ extern "C" {
 #define MCP23017_ADDR 0x40
 #define MCP23017_READBIT 0x01
 
+/* IOCON bits */
+#define IOCON_INTPOL BIT(1)
+#define IOCON_ODR BIT(2)
+#define IOCON_MIRROR BIT(6)
+
+/* Pins of each port in a register pair */
+#define MCP23017_PORTA_PINS 0x00FF
+#define MCP23017_PORTB_PINS 0xFF00
+
+/* Number of interrupt outputs, INTA and INTB */
+#define MCP23017_INT_GPIOS_MAX 2
+
 /** Configuration data */
 struct mcp23017_config {
     /* gpio_driver_data needs to be first */
@@ -52,6 +65,15 @@ struct mcp23017_config {
 
     const char *const i2c_dev_name;
     const uint16_t slave;
+
+    /** Host GPIOs connected to INTA and optionally INTB. */
+    const struct gpio_dt_spec *int_gpios;
+    uint8_t int_gpios_len;
+};
+
+struct mcp23017_int_callback {
+    const struct device *dev;
+    struct gpio_callback callback;
 };
 
 /** Runtime driver data */
@@ -64,6 +86,20 @@ struct mcp23017_drv_data {
 
     struct k_sem lock;
 
+    const struct device *dev;
+
+    /** Pins configured as inputs. Only the ports containing these are read. */
+    uint16_t input_pins;
+
+    /** Callbacks added with gpio_add_callback(). */
+    sys_slist_t callbacks;
+    /** Edge interrupt pins which only fire on a rising or falling edge. */
+    uint16_t int_rising;
+    uint16_t int_falling;
+    /** Reads and clears the interrupt flags after the host interrupt fires. */
+    struct k_work int_work;
+    struct mcp23017_int_callback int_callbacks[MCP23017_INT_GPIOS_MAX];
+
     struct {
         uint16_t iodir;
         uint16_t ipol;
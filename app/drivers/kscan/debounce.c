@@ -6,6 +6,8 @@
 
 #include "debounce.h"
 
+#include <sys/math_extras.h>
+
 static uint32_t get_threshold(const struct debounce_state *state,
                               const struct debounce_config *config) {
     return state->pressed ? config->debounce_release_ms : config->debounce_press_ms;
@@ -36,6 +38,25 @@ void debounce_update(struct debounce_state *state, const bool active, const int
     // threshold, the state flips and we reset the counter.
     state->changed = false;
 
+    if (config->eager_press) {
+        if (state->lockout) {
+            // Ignore any chatter until the lockout after an eager press has passed.
+            decrement_counter(state, elapsed_ms);
+            state->lockout = state->counter > 0;
+            return;
+        }
+
+        if (active && !state->pressed) {
+            state->pressed = true;
+            state->counter = MIN(config->debounce_press_ms, DEBOUNCE_COUNTER_MAX);
+            state->lockout = state->counter > 0;
+            state->changed = true;
+            return;
+        }
+
+        // Releases are still deferred by the integrator below.
+    }
+
     if (active == state->pressed) {
         decrement_counter(state, elapsed_ms);
         return;
@@ -59,4 +80,100 @@ bool debounce_is_active(const struct debounce_state *state) {
 
 bool debounce_is_pressed(const struct debounce_state *state) { return state->pressed; }
 
-bool debounce_get_changed(const struct debounce_state *state) { return state->changed; }
\ No newline at end of file
+bool debounce_get_changed(const struct debounce_state *state) { return state->changed; }
+/**
+ * @returns the number of counter bits needed to count up to the larger threshold.
+ */
+static int get_word_counter_bits(const struct debounce_word_config *config) {
+    const uint32_t max_scans = MAX(config->press_scans, config->release_scans);
+    return max_scans == 0 ? 0 : 32 - u32_count_leading_zeros(max_scans);
+}
+
+/**
+ * @returns a mask of the switches whose counter is greater than or equal to threshold.
+ */
+static uint32_t word_counter_at_least(const struct debounce_word_state *state, const int bits,
+                                      const uint32_t threshold) {
+    uint32_t greater = 0;
+    uint32_t equal = UINT32_MAX;
+
+    for (int k = bits - 1; k >= 0; k--) {
+        if (threshold & BIT(k)) {
+            equal &= state->counter[k];
+        } else {
+            greater |= equal & state->counter[k];
+            equal &= ~state->counter[k];
+        }
+    }
+
+    return greater | equal;
+}
+
+static void word_counter_increment(struct debounce_word_state *state, const int bits,
+                                   uint32_t mask) {
+    for (int k = 0; k < bits && mask; k++) {
+        const uint32_t carry = state->counter[k] & mask;
+        state->counter[k] ^= mask;
+        mask = carry;
+    }
+}
+
+static void word_counter_decrement(struct debounce_word_state *state, const int bits,
+                                   uint32_t mask) {
+    for (int k = 0; k < bits && mask; k++) {
+        const uint32_t borrow = ~state->counter[k] & mask;
+        state->counter[k] ^= mask;
+        mask = borrow;
+    }
+}
+
+static void word_counter_clear(struct debounce_word_state *state, const int bits,
+                               const uint32_t mask) {
+    for (int k = 0; k < bits; k++) {
+        state->counter[k] &= ~mask;
+    }
+}
+
+static uint32_t word_counter_nonzero(const struct debounce_word_state *state, const int bits) {
+    uint32_t nonzero = 0;
+
+    for (int k = 0; k < bits; k++) {
+        nonzero |= state->counter[k];
+    }
+
+    return nonzero;
+}
+
+void debounce_word_update(struct debounce_word_state *state, const uint32_t active,
+                          const struct debounce_word_config *config) {
+    // Same integrator as debounce_update(), applied to every switch at once: switches which
+    // disagree with their latched state count up until they reach their threshold and flip,
+    // and the rest count back down towards zero.
+    const int bits = get_word_counter_bits(config);
+
+    const uint32_t disagree = active ^ state->pressed;
+    const uint32_t at_threshold =
+        (~state->pressed & word_counter_at_least(state, bits, config->press_scans)) |
+        (state->pressed & word_counter_at_least(state, bits, config->release_scans));
+
+    const uint32_t flip = disagree & at_threshold;
+    const uint32_t increment = disagree & ~at_threshold;
+    const uint32_t decrement = ~disagree & word_counter_nonzero(state, bits);
+
+    word_counter_increment(state, bits, increment);
+    word_counter_decrement(state, bits, decrement);
+    word_counter_clear(state, bits, flip);
+
+    state->pressed ^= flip;
+    state->changed = flip;
+}
+
+uint32_t debounce_word_get_active(const struct debounce_word_state *state) {
+    uint32_t nonzero = 0;
+
+    for (int k = 0; k < DEBOUNCE_COUNTER_BITS; k++) {
+        nonzero |= state->counter[k];
+    }
+
+    return state->pressed | nonzero;
+}
@@ -16,14 +16,21 @@
 struct debounce_state {
     bool pressed : 1;
     bool changed : 1;
+    /** Ignoring the switch after an eager press. The counter holds the remaining time. */
+    bool lockout : 1;
     uint16_t counter : DEBOUNCE_COUNTER_BITS;
 };
 
 struct debounce_config {
-    /** Duration a switch must be pressed to latch as pressed. */
+    /**
+     * Duration a switch must be pressed to latch as pressed. With eager_press, the duration
+     * the switch is ignored after it latches as pressed instead.
+     */
     uint32_t debounce_press_ms;
     /** Duration a switch must be released to latch as released. */
     uint32_t debounce_release_ms;
+    /** Latch a press on the first active update, then ignore chatter for debounce_press_ms. */
+    bool eager_press;
 };
 
 /**
@@ -54,3 +61,67 @@ bool debounce_is_pressed(const struct debounce_state *state);
  * debounce_update.
  */
 bool debounce_get_changed(const struct debounce_state *state);
+
+/*
+ * Bit-parallel version of the debouncer above, which updates up to 32 switches at once. Bit n of
+ * every word belongs to switch n. Each switch's counter is stored as a "vertical" binary number,
+ * with bit n of counter[k] holding bit k of switch n's counter.
+ *
+ * Counters count scans rather than milliseconds, so the switches must be updated every
+ * debounce-scan-period-ms. The thresholds are rounded up to a whole number of scans, which gives
+ * the same decisions as debounce_update() with that scan period.
+ */
+
+#define DEBOUNCE_WORD_BITS 32
+
+struct debounce_word_state {
+    uint32_t pressed;
+    uint32_t changed;
+    uint32_t counter[DEBOUNCE_COUNTER_BITS];
+};
+
+struct debounce_word_config {
+    /** Number of scans a switch must be pressed to latch as pressed. */
+    uint16_t press_scans;
+    /** Number of scans a switch must be released to latch as released. */
+    uint16_t release_scans;
+};
+
+/**
+ * Initializer for a debounce_word_config from millisecond debounce times.
+ */
+#define DEBOUNCE_WORD_CONFIG(press_ms, release_ms, scan_period_ms)                                 \
+    ((struct debounce_word_config){                                                                \
+        .press_scans = DIV_ROUND_UP(press_ms, scan_period_ms),                                     \
+        .release_scans = DIV_ROUND_UP(release_ms, scan_period_ms),                                 \
+    })
+
+/**
+ * Debounces up to 32 switches.
+ *
+ * @param state The state for the switches to debounce.
+ * @param active Bit mask of the switches which are currently pressed.
+ * @param config Debounce settings.
+ */
+void debounce_word_update(struct debounce_word_state *state, const uint32_t active,
+                          const struct debounce_word_config *config);
+
+/**
+ * @returns a mask of the switches for which debounce_is_active() would return true.
+ */
+uint32_t debounce_word_get_active(const struct debounce_word_state *state);
+
+/**
+ * @returns a mask of the switches which are latched as pressed.
+ */
+static inline uint32_t debounce_word_get_pressed(const struct debounce_word_state *state) {
+    return state->pressed;
+}
+
+/**
+ * @returns a mask of the switches whose pressed state changed in the last call to
+ * debounce_word_update.
+ */
+static inline uint32_t debounce_word_get_changed(const struct debounce_word_state *state) {
+    return state->changed;
+}
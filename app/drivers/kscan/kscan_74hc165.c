@@ -0,0 +1,468 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_kscan_74hc165
+
+#include "debounce.h"
+
+#include <device.h>
+#include <devicetree.h>
+#include <drivers/gpio.h>
+#include <drivers/kscan.h>
+#include <drivers/spi.h>
+#include <kernel.h>
+#include <logging/log.h>
+#include <sys/util.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define INST_CHAIN_LEN(n) DT_INST_PROP(n, chain_length)
+#define INST_INPUTS_LEN(n) (INST_CHAIN_LEN(n) * 8)
+#define INST_ROWS_LEN(n) DT_INST_PROP_LEN_OR(n, row_gpios, 0)
+#define INST_MATRIX_LEN(n) (MAX(INST_ROWS_LEN(n), 1) * INST_INPUTS_LEN(n))
+
+#if CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS >= 0
+#define INST_DEBOUNCE_PRESS_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS
+#else
+#define INST_DEBOUNCE_PRESS_MS(n) DT_INST_PROP(n, debounce_press_ms)
+#endif
+
+#if CONFIG_ZMK_KSCAN_DEBOUNCE_RELEASE_MS >= 0
+#define INST_DEBOUNCE_RELEASE_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_RELEASE_MS
+#else
+#define INST_DEBOUNCE_RELEASE_MS(n) DT_INST_PROP(n, debounce_release_ms)
+#endif
+
+#define KSCAN_74HC165_ROW_CFG_INIT(idx, inst_idx)                                                  \
+    GPIO_DT_SPEC_GET_BY_IDX(DT_DRV_INST(inst_idx), row_gpios, idx),
+
+struct kscan_74hc165_irq_callback {
+    const struct device *dev;
+    struct gpio_callback callback;
+};
+
+struct kscan_74hc165_data {
+    const struct device *dev;
+    kscan_callback_t callback;
+    struct k_work_delayable work;
+    struct kscan_74hc165_irq_callback irq;
+    /** Timestamp of the current or scheduled scan. */
+    int64_t scan_time;
+    /** Values from the last read of the chain, with one byte per register. */
+    uint8_t *inputs;
+    /**
+     * Current state of the keys as a flattened 2D array of length
+     * (max(config->rows_len, 1) * config->inputs_len).
+     */
+    struct debounce_state *key_state;
+};
+
+struct kscan_74hc165_config {
+    struct spi_dt_spec bus;
+    /** GPIO connected to SH/LD, or a NULL port if SH/LD is driven by the chip select. */
+    struct gpio_dt_spec load_gpio;
+    /** GPIO which is active while any key is pressed, or a NULL port to poll. */
+    struct gpio_dt_spec interrupt_gpio;
+    /** Matrix row GPIOs, or NULL if each input is a directly wired key. */
+    const struct gpio_dt_spec *rows;
+    size_t rows_len;
+    size_t chain_len;
+    size_t inputs_len;
+    bool active_low;
+    struct debounce_config debounce_config;
+    int32_t debounce_scan_period_ms;
+    int32_t poll_period_ms;
+};
+
+static bool kscan_74hc165_use_interrupts(const struct device *dev) {
+    const struct kscan_74hc165_config *config = dev->config;
+
+    return config->interrupt_gpio.port != NULL;
+}
+
+static int kscan_74hc165_set_all_rows(const struct device *dev, const int value) {
+    const struct kscan_74hc165_config *config = dev->config;
+
+    for (int i = 0; i < config->rows_len; i++) {
+        int err = gpio_pin_set_dt(&config->rows[i], value);
+        if (err) {
+            LOG_ERR("Failed to set row %i to %i: %i", i, value, err);
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+static int kscan_74hc165_interrupt_enable(const struct device *dev) {
+    const struct kscan_74hc165_config *config = dev->config;
+
+    // While interrupts are enabled, set all rows active so a pressed key
+    // will trigger an interrupt.
+    int err = kscan_74hc165_set_all_rows(dev, 1);
+    if (err) {
+        return err;
+    }
+
+    err = gpio_pin_interrupt_configure_dt(&config->interrupt_gpio, GPIO_INT_LEVEL_ACTIVE);
+    if (err) {
+        LOG_ERR("Unable to configure interrupt for pin %u on %s", config->interrupt_gpio.pin,
+                config->interrupt_gpio.port->name);
+    }
+
+    return err;
+}
+
+static int kscan_74hc165_interrupt_disable(const struct device *dev) {
+    const struct kscan_74hc165_config *config = dev->config;
+
+    int err = gpio_pin_interrupt_configure_dt(&config->interrupt_gpio, GPIO_INT_DISABLE);
+    if (err) {
+        LOG_ERR("Unable to configure interrupt for pin %u on %s", config->interrupt_gpio.pin,
+                config->interrupt_gpio.port->name);
+        return err;
+    }
+
+    // While interrupts are disabled, set all rows inactive so
+    // kscan_74hc165_read() can scan them one by one.
+    return kscan_74hc165_set_all_rows(dev, 0);
+}
+
+static void kscan_74hc165_irq_callback_handler(const struct device *port, struct gpio_callback *cb,
+                                               const gpio_port_pins_t pin) {
+    struct kscan_74hc165_irq_callback *irq_data =
+        CONTAINER_OF(cb, struct kscan_74hc165_irq_callback, callback);
+    struct kscan_74hc165_data *data = irq_data->dev->data;
+
+    // Disable our interrupts temporarily to avoid re-entry while we scan.
+    kscan_74hc165_interrupt_disable(data->dev);
+
+    data->scan_time = k_uptime_get();
+
+    k_work_reschedule(&data->work, K_NO_WAIT);
+}
+
+static void kscan_74hc165_read_continue(const struct device *dev) {
+    const struct kscan_74hc165_config *config = dev->config;
+    struct kscan_74hc165_data *data = dev->data;
+
+    data->scan_time += config->debounce_scan_period_ms;
+
+    k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+}
+
+static void kscan_74hc165_read_end(const struct device *dev) {
+    const struct kscan_74hc165_config *config = dev->config;
+    struct kscan_74hc165_data *data = dev->data;
+
+    if (kscan_74hc165_use_interrupts(dev)) {
+        // Return to waiting for an interrupt.
+        kscan_74hc165_interrupt_enable(dev);
+        return;
+    }
+
+    data->scan_time += config->poll_period_ms;
+
+    // Return to polling slowly.
+    k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+}
+
+/**
+ * Latch the inputs of every register and shift them all out in one SPI transfer.
+ */
+static int kscan_74hc165_read_chain(const struct device *dev) {
+    const struct kscan_74hc165_config *config = dev->config;
+    struct kscan_74hc165_data *data = dev->data;
+
+    if (config->load_gpio.port) {
+        int err = gpio_pin_set_dt(&config->load_gpio, 1);
+        if (!err) {
+            err = gpio_pin_set_dt(&config->load_gpio, 0);
+        }
+        if (err) {
+            LOG_ERR("Failed to load the shift registers: %i", err);
+            return err;
+        }
+    }
+
+    const struct spi_buf rx_buf = {
+        .buf = data->inputs,
+        .len = config->chain_len,
+    };
+    const struct spi_buf_set rx = {
+        .buffers = &rx_buf,
+        .count = 1,
+    };
+
+    int err = spi_read_dt(&config->bus, &rx);
+    if (err) {
+        LOG_ERR("Failed to read the shift registers: %i", err);
+    }
+
+    return err;
+}
+
+/**
+ * @returns whether an input was active in the last kscan_74hc165_read_chain(). The first byte
+ * shifted out is from the register nearest to the controller, and D7 is its first bit.
+ */
+static bool kscan_74hc165_input_is_active(const struct device *dev, const int input_idx) {
+    const struct kscan_74hc165_config *config = dev->config;
+    const struct kscan_74hc165_data *data = dev->data;
+
+    const bool high = data->inputs[input_idx / 8] & BIT(input_idx % 8);
+
+    return high != config->active_low;
+}
+
+/**
+ * Read the chain for one row, or once for directly wired keys, and update its debouncers.
+ */
+static int kscan_74hc165_read_row(const struct device *dev, const int row) {
+    const struct kscan_74hc165_config *config = dev->config;
+    struct kscan_74hc165_data *data = dev->data;
+    int err;
+
+    if (config->rows_len > 0) {
+        err = gpio_pin_set_dt(&config->rows[row], 1);
+        if (err) {
+            LOG_ERR("Failed to set row %i active: %i", row, err);
+            return err;
+        }
+    }
+
+    err = kscan_74hc165_read_chain(dev);
+
+    if (config->rows_len > 0) {
+        int row_err = gpio_pin_set_dt(&config->rows[row], 0);
+        if (row_err) {
+            LOG_ERR("Failed to set row %i inactive: %i", row, row_err);
+            return row_err;
+        }
+    }
+
+    if (err) {
+        return err;
+    }
+
+    for (int i = 0; i < config->inputs_len; i++) {
+        struct debounce_state *state = &data->key_state[(row * config->inputs_len) + i];
+
+        debounce_update(state, kscan_74hc165_input_is_active(dev, i),
+                        config->debounce_scan_period_ms, &config->debounce_config);
+    }
+
+    return 0;
+}
+
+static int kscan_74hc165_read(const struct device *dev) {
+    const struct kscan_74hc165_config *config = dev->config;
+    struct kscan_74hc165_data *data = dev->data;
+    const int rows_len = MAX(config->rows_len, 1);
+    bool continue_scan = false;
+
+    // Scan the keys.
+    for (int r = 0; r < rows_len; r++) {
+        int err = kscan_74hc165_read_row(dev, r);
+        if (err) {
+            return err;
+        }
+    }
+
+    // Process the new state.
+    for (int r = 0; r < rows_len; r++) {
+        for (int c = 0; c < config->inputs_len; c++) {
+            struct debounce_state *state = &data->key_state[(r * config->inputs_len) + c];
+
+            if (debounce_get_changed(state)) {
+                const bool pressed = debounce_is_pressed(state);
+
+                LOG_DBG("Sending event at %i,%i state %s", r, c, pressed ? "on" : "off");
+                data->callback(dev, r, c, pressed);
+            }
+
+            continue_scan = continue_scan || debounce_is_active(state);
+        }
+    }
+
+    if (continue_scan) {
+        // At least one key is pressed or the debouncer has not yet decided if
+        // it is pressed. Poll quickly until everything is released.
+        kscan_74hc165_read_continue(dev);
+    } else {
+        // All keys are released. Return to normal.
+        kscan_74hc165_read_end(dev);
+    }
+
+    return 0;
+}
+
+static void kscan_74hc165_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = CONTAINER_OF(work, struct k_work_delayable, work);
+    struct kscan_74hc165_data *data = CONTAINER_OF(dwork, struct kscan_74hc165_data, work);
+    kscan_74hc165_read(data->dev);
+}
+
+static int kscan_74hc165_configure(const struct device *dev, const kscan_callback_t callback) {
+    struct kscan_74hc165_data *data = dev->data;
+
+    if (!callback) {
+        return -EINVAL;
+    }
+
+    data->callback = callback;
+    return 0;
+}
+
+static int kscan_74hc165_enable(const struct device *dev) {
+    struct kscan_74hc165_data *data = dev->data;
+
+    data->scan_time = k_uptime_get();
+
+    // Read will automatically start interrupts/polling once done.
+    return kscan_74hc165_read(dev);
+}
+
+static int kscan_74hc165_disable(const struct device *dev) {
+    struct kscan_74hc165_data *data = dev->data;
+
+    k_work_cancel_delayable(&data->work);
+
+    if (kscan_74hc165_use_interrupts(dev)) {
+        return kscan_74hc165_interrupt_disable(dev);
+    }
+
+    return 0;
+}
+
+static int kscan_74hc165_init_output(const struct gpio_dt_spec *gpio) {
+    if (!device_is_ready(gpio->port)) {
+        LOG_ERR("GPIO is not ready: %s", gpio->port->name);
+        return -ENODEV;
+    }
+
+    int err = gpio_pin_configure_dt(gpio, GPIO_OUTPUT_INACTIVE);
+    if (err) {
+        LOG_ERR("Unable to configure pin %u on %s for output", gpio->pin, gpio->port->name);
+    }
+
+    return err;
+}
+
+static int kscan_74hc165_init_interrupt(const struct device *dev) {
+    const struct kscan_74hc165_config *config = dev->config;
+    struct kscan_74hc165_data *data = dev->data;
+    const struct gpio_dt_spec *gpio = &config->interrupt_gpio;
+
+    if (!device_is_ready(gpio->port)) {
+        LOG_ERR("GPIO is not ready: %s", gpio->port->name);
+        return -ENODEV;
+    }
+
+    int err = gpio_pin_configure_dt(gpio, GPIO_INPUT);
+    if (err) {
+        LOG_ERR("Unable to configure pin %u on %s for input", gpio->pin, gpio->port->name);
+        return err;
+    }
+
+    data->irq.dev = dev;
+    gpio_init_callback(&data->irq.callback, kscan_74hc165_irq_callback_handler, BIT(gpio->pin));
+    err = gpio_add_callback(gpio->port, &data->irq.callback);
+    if (err) {
+        LOG_ERR("Error adding the callback to the interrupt device: %i", err);
+    }
+
+    return err;
+}
+
+static int kscan_74hc165_init(const struct device *dev) {
+    const struct kscan_74hc165_config *config = dev->config;
+    struct kscan_74hc165_data *data = dev->data;
+    int err;
+
+    data->dev = dev;
+
+    if (!device_is_ready(config->bus.bus)) {
+        LOG_ERR("SPI bus is not ready: %s", config->bus.bus->name);
+        return -ENODEV;
+    }
+
+    if (config->load_gpio.port) {
+        err = kscan_74hc165_init_output(&config->load_gpio);
+        if (err) {
+            return err;
+        }
+    }
+
+    for (int i = 0; i < config->rows_len; i++) {
+        err = kscan_74hc165_init_output(&config->rows[i]);
+        if (err) {
+            return err;
+        }
+    }
+
+    if (kscan_74hc165_use_interrupts(dev)) {
+        err = kscan_74hc165_init_interrupt(dev);
+        if (err) {
+            return err;
+        }
+    }
+
+    k_work_init_delayable(&data->work, kscan_74hc165_work_handler);
+
+    return 0;
+}
+
+static const struct kscan_driver_api kscan_74hc165_api = {
+    .config = kscan_74hc165_configure,
+    .enable_callback = kscan_74hc165_enable,
+    .disable_callback = kscan_74hc165_disable,
+};
+
+#define KSCAN_74HC165_INIT(n)                                                                      \
+    BUILD_ASSERT(INST_DEBOUNCE_PRESS_MS(n) <= DEBOUNCE_COUNTER_MAX,                                \
+                 "ZMK_KSCAN_DEBOUNCE_PRESS_MS or debounce-press-ms is too large");                 \
+    BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
+                 "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
+                                                                                                   \
+    COND_CODE_1(DT_INST_NODE_HAS_PROP(n, row_gpios),                                               \
+                (static const struct gpio_dt_spec kscan_74hc165_rows_##n[] = {                     \
+                     UTIL_LISTIFY(INST_ROWS_LEN(n), KSCAN_74HC165_ROW_CFG_INIT, n)};),             \
+                ())                                                                                \
+                                                                                                   \
+    static uint8_t kscan_74hc165_inputs_##n[INST_CHAIN_LEN(n)];                                    \
+    static struct debounce_state kscan_74hc165_state_##n[INST_MATRIX_LEN(n)];                      \
+                                                                                                   \
+    static struct kscan_74hc165_data kscan_74hc165_data_##n = {                                    \
+        .inputs = kscan_74hc165_inputs_##n,                                                        \
+        .key_state = kscan_74hc165_state_##n,                                                      \
+    };                                                                                             \
+                                                                                                   \
+    static const struct kscan_74hc165_config kscan_74hc165_config_##n = {                          \
+        .bus = SPI_DT_SPEC_INST_GET(n, SPI_OP_MODE_MASTER | SPI_TRANSFER_MSB | SPI_WORD_SET(8),    \
+                                    0),                                                            \
+        .load_gpio = GPIO_DT_SPEC_INST_GET_OR(n, load_gpios, {0}),                                 \
+        .interrupt_gpio = GPIO_DT_SPEC_INST_GET_OR(n, interrupt_gpios, {0}),                       \
+        COND_CODE_1(DT_INST_NODE_HAS_PROP(n, row_gpios), (.rows = kscan_74hc165_rows_##n, ), ())   \
+        .rows_len = INST_ROWS_LEN(n),                                                              \
+        .chain_len = INST_CHAIN_LEN(n),                                                            \
+        .inputs_len = INST_INPUTS_LEN(n),                                                          \
+        .active_low = DT_INST_PROP(n, active_low),                                                 \
+        .debounce_config =                                                                         \
+            {                                                                                      \
+                .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
+                .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
+                .eager_press = DT_INST_PROP(n, debounce_eager_press),                              \
+            },                                                                                     \
+        .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
+        .poll_period_ms = DT_INST_PROP(n, poll_period_ms),                                         \
+    };                                                                                             \
+                                                                                                   \
+    DEVICE_DT_INST_DEFINE(n, &kscan_74hc165_init, NULL, &kscan_74hc165_data_##n,                   \
+                          &kscan_74hc165_config_##n, APPLICATION,                                  \
+                          CONFIG_APPLICATION_INIT_PRIORITY, &kscan_74hc165_api);
+
+DT_INST_FOREACH_STATUS_OKAY(KSCAN_74HC165_INIT);
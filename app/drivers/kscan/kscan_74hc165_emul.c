@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * Emulates a chain of 74HC165 shift registers on an emulated SPI bus, so the
+ * zmk,kscan-74hc165 driver can be tested on native_posix. The inputs follow the
+ * devicetree events property, played back with the same timing as zmk,kscan-mock.
+ */
+
+#define DT_DRV_COMPAT zmk_kscan_74hc165
+
+#include <stdlib.h>
+#include <device.h>
+#include <drivers/emul.h>
+#include <drivers/spi.h>
+#include <drivers/spi_emul.h>
+#include <logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <dt-bindings/zmk/kscan_mock.h>
+
+struct kscan_74hc165_emul_config {
+    struct kscan_74hc165_emul_data *data;
+    const uint32_t *events;
+    size_t events_len;
+    uint16_t chipsel;
+    uint8_t chain_len;
+    bool active_low;
+    bool exit_after;
+};
+
+struct kscan_74hc165_emul_data {
+    struct spi_emul emul_spi;
+    const struct kscan_74hc165_emul_config *cfg;
+    /** Pressed state of each input, with one byte per register. */
+    uint8_t *pressed;
+    uint32_t event_index;
+    /** Time of the next event, or of exiting once all events have been played. */
+    int64_t next_event_time;
+};
+
+static void kscan_74hc165_emul_play_events(struct kscan_74hc165_emul_data *data) {
+    const struct kscan_74hc165_emul_config *cfg = data->cfg;
+    const int64_t now = k_uptime_get();
+
+    while (data->event_index < cfg->events_len && now >= data->next_event_time) {
+        const uint32_t ev = cfg->events[data->event_index];
+        const uint32_t input = ZMK_MOCK_COL(ev);
+
+        if (ZMK_MOCK_ROW(ev) != 0 || input >= cfg->chain_len * 8) {
+            LOG_WRN("Ignoring event for %d,%d outside of the chain", ZMK_MOCK_ROW(ev), input);
+        } else {
+            LOG_DBG("Emulated input %d %s", input, ZMK_MOCK_IS_PRESS(ev) ? "pressed" : "released");
+            WRITE_BIT(data->pressed[input / 8], input % 8, ZMK_MOCK_IS_PRESS(ev));
+        }
+
+        // Like zmk,kscan-mock, each event's delay is the time until the next event.
+        data->next_event_time += ZMK_MOCK_MSEC(ev);
+        data->event_index++;
+    }
+
+    if (cfg->exit_after && data->event_index == cfg->events_len && now >= data->next_event_time) {
+        LOG_DBG("Exiting");
+        exit(0);
+    }
+}
+
+static int kscan_74hc165_emul_io(struct spi_emul *emul, const struct spi_config *config,
+                                 const struct spi_buf_set *tx_bufs,
+                                 const struct spi_buf_set *rx_bufs) {
+    struct kscan_74hc165_emul_data *data =
+        CONTAINER_OF(emul, struct kscan_74hc165_emul_data, emul_spi);
+    const struct kscan_74hc165_emul_config *cfg = data->cfg;
+    size_t offset = 0;
+
+    kscan_74hc165_emul_play_events(data);
+
+    if (!rx_bufs) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < rx_bufs->count; i++) {
+        uint8_t *buf = rx_bufs->buffers[i].buf;
+
+        for (size_t j = 0; j < rx_bufs->buffers[i].len; j++, offset++) {
+            // Reading past the end of the chain shifts in the serial input, which is tied low.
+            const uint8_t pressed = (offset < cfg->chain_len) ? data->pressed[offset] : 0;
+            const uint8_t value = (offset < cfg->chain_len && cfg->active_low) ? ~pressed : pressed;
+
+            if (buf) {
+                buf[j] = value;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static const struct spi_emul_api kscan_74hc165_emul_api = {
+    .io = kscan_74hc165_emul_io,
+};
+
+static int kscan_74hc165_emul_init(const struct emul *emul, const struct device *parent) {
+    const struct kscan_74hc165_emul_config *cfg = emul->cfg;
+    struct kscan_74hc165_emul_data *data = cfg->data;
+
+    data->cfg = cfg;
+    data->emul_spi.api = &kscan_74hc165_emul_api;
+    data->emul_spi.chipsel = cfg->chipsel;
+
+    if (cfg->events_len > 0) {
+        data->next_event_time = k_uptime_get() + ZMK_MOCK_MSEC(cfg->events[0]);
+    }
+
+    return spi_emul_register(parent, emul->dev_label, &data->emul_spi);
+}
+
+#define KSCAN_74HC165_EMUL_INIT(n)                                                                 \
+    COND_CODE_1(DT_INST_NODE_HAS_PROP(n, events),                                                  \
+                (static const uint32_t kscan_74hc165_emul_events_##n[] =                           \
+                     DT_INST_PROP(n, events);),                                                    \
+                ())                                                                                \
+                                                                                                   \
+    static uint8_t kscan_74hc165_emul_pressed_##n[DT_INST_PROP(n, chain_length)];                  \
+                                                                                                   \
+    static struct kscan_74hc165_emul_data kscan_74hc165_emul_data_##n = {                          \
+        .pressed = kscan_74hc165_emul_pressed_##n,                                                 \
+    };                                                                                             \
+                                                                                                   \
+    static const struct kscan_74hc165_emul_config kscan_74hc165_emul_config_##n = {               \
+        .data = &kscan_74hc165_emul_data_##n,                                                      \
+        COND_CODE_1(DT_INST_NODE_HAS_PROP(n, events),                                              \
+                    (.events = kscan_74hc165_emul_events_##n,                                      \
+                     .events_len = ARRAY_SIZE(kscan_74hc165_emul_events_##n), ),                   \
+                    ())                                                                            \
+        .chipsel = DT_INST_REG_ADDR(n),                                                            \
+        .chain_len = DT_INST_PROP(n, chain_length),                                                \
+        .active_low = DT_INST_PROP(n, active_low),                                                 \
+        .exit_after = DT_INST_PROP(n, exit_after),                                                 \
+    };                                                                                             \
+                                                                                                   \
+    EMUL_DEFINE(kscan_74hc165_emul_init, DT_DRV_INST(n), &kscan_74hc165_emul_config_##n)
+
+DT_INST_FOREACH_STATUS_OKAY(KSCAN_74HC165_EMUL_INIT)
@@ -16,19 +16,12 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #define MATRIX_COLS DT_PROP(MATRIX_NODE_ID, columns)
 
 struct kscan_composite_child_config {
-    char *label;
+    const struct device *dev;
+    kscan_callback_t callback;
     uint8_t row_offset;
     uint8_t column_offset;
 };
 
-#define CHILD_CONFIG(inst)                                                                         \
-    {.label = DT_LABEL(DT_PHANDLE(inst, kscan)),                                                   \
-     .row_offset = DT_PROP(inst, row_offset),                                                      \
-     .column_offset = DT_PROP(inst, column_offset)},
-
-const struct kscan_composite_child_config kscan_composite_children[] = {
-    DT_FOREACH_CHILD(MATRIX_NODE_ID, CHILD_CONFIG)};
-
 struct kscan_composite_config {};
 
 struct kscan_composite_data {
@@ -37,49 +30,65 @@ struct kscan_composite_data {
     const struct device *dev;
 };
 
-static int kscan_composite_enable_callback(const struct device *dev) {
-    for (int i = 0; i < ARRAY_SIZE(kscan_composite_children); i++) {
-        const struct kscan_composite_child_config *cfg = &kscan_composite_children[i];
+static struct kscan_composite_data kscan_composite_data;
 
-        const struct device *dev = device_get_binding(cfg->label);
-        if (!dev) {
-            LOG_WRN("Failed to load child kscan device %s", log_strdup(cfg->label));
-            continue;
-        }
-        kscan_enable_callback(dev);
-    }
-    return 0;
+static void kscan_composite_child_callback(const struct kscan_composite_child_config *cfg,
+                                           uint32_t row, uint32_t column, bool pressed) {
+    struct kscan_composite_data *data = &kscan_composite_data;
+
+    data->callback(data->dev, row + cfg->row_offset, column + cfg->column_offset, pressed);
 }
 
-static int kscan_composite_disable_callback(const struct device *dev) {
+#define CHILD_NAME(inst, prefix) UTIL_CAT(prefix, DT_DEP_ORD(inst))
+
+// Each child gets its own callback which already knows the child's offsets, so key events are
+// dispatched without looking up the child device.
+#define CHILD_CONFIG(inst)                                                                         \
+    static void CHILD_NAME(inst, kscan_composite_child_callback_)(                                 \
+        const struct device *child_dev, uint32_t row, uint32_t column, bool pressed);              \
+                                                                                                   \
+    static const struct kscan_composite_child_config CHILD_NAME(inst, kscan_composite_child_) = {  \
+        .dev = DEVICE_DT_GET(DT_PHANDLE(inst, kscan)),                                             \
+        .callback = CHILD_NAME(inst, kscan_composite_child_callback_),                             \
+        .row_offset = DT_PROP(inst, row_offset),                                                   \
+        .column_offset = DT_PROP(inst, column_offset),                                             \
+    };                                                                                             \
+                                                                                                   \
+    static void CHILD_NAME(inst, kscan_composite_child_callback_)(                                 \
+        const struct device *child_dev, uint32_t row, uint32_t column, bool pressed) {             \
+        kscan_composite_child_callback(&CHILD_NAME(inst, kscan_composite_child_), row, column,     \
+                                       pressed);                                                   \
+    }
+
+DT_FOREACH_CHILD(MATRIX_NODE_ID, CHILD_CONFIG)
+
+#define CHILD_ENTRY(inst) &CHILD_NAME(inst, kscan_composite_child_),
+
+static const struct kscan_composite_child_config *const kscan_composite_children[] = {
+    DT_FOREACH_CHILD(MATRIX_NODE_ID, CHILD_ENTRY)};
+
+static int kscan_composite_enable_callback(const struct device *dev) {
     for (int i = 0; i < ARRAY_SIZE(kscan_composite_children); i++) {
-        const struct kscan_composite_child_config *cfg = &kscan_composite_children[i];
+        const struct kscan_composite_child_config *cfg = kscan_composite_children[i];
 
-        const struct device *dev = device_get_binding(cfg->label);
-        if (!dev) {
-            LOG_WRN("Failed to load child kscan device %s", log_strdup(cfg->label));
+        if (!device_is_ready(cfg->dev)) {
             continue;
         }
-        kscan_disable_callback(dev);
+        kscan_enable_callback(cfg->dev);
     }
     return 0;
 }
 
-static void kscan_composite_child_callback(const struct device *child_dev, uint32_t row,
-                                           uint32_t column, bool pressed) {
-    // TODO: Ideally we can get this passed into our callback!
-    const struct device *dev = device_get_binding(DT_INST_LABEL(0));
-    struct kscan_composite_data *data = dev->data;
-
+static int kscan_composite_disable_callback(const struct device *dev) {
     for (int i = 0; i < ARRAY_SIZE(kscan_composite_children); i++) {
-        const struct kscan_composite_child_config *cfg = &kscan_composite_children[i];
+        const struct kscan_composite_child_config *cfg = kscan_composite_children[i];
 
-        if (device_get_binding(cfg->label) != child_dev) {
+        if (!device_is_ready(cfg->dev)) {
             continue;
         }
-
-        data->callback(dev, row + cfg->row_offset, column + cfg->column_offset, pressed);
+        kscan_disable_callback(cfg->dev);
     }
+    return 0;
 }
 
 static int kscan_composite_configure(const struct device *dev, kscan_callback_t callback) {
@@ -89,14 +98,18 @@ static int kscan_composite_configure(const struct device *dev, kscan_callback_t
         return -EINVAL;
     }
 
+    data->callback = callback;
+
     for (int i = 0; i < ARRAY_SIZE(kscan_composite_children); i++) {
-        const struct kscan_composite_child_config *cfg = &kscan_composite_children[i];
+        const struct kscan_composite_child_config *cfg = kscan_composite_children[i];
 
-        kscan_config(device_get_binding(cfg->label), &kscan_composite_child_callback);
+        if (!device_is_ready(cfg->dev)) {
+            LOG_WRN("Child kscan device %s is not ready", cfg->dev->name);
+            continue;
+        }
+        kscan_config(cfg->dev, cfg->callback);
     }
 
-    data->callback = callback;
-
     return 0;
 }
 
@@ -116,7 +129,5 @@ static const struct kscan_driver_api mock_driver_api = {
 
 static const struct kscan_composite_config kscan_composite_config = {};
 
-static struct kscan_composite_data kscan_composite_data;
-
 DEVICE_DT_INST_DEFINE(0, kscan_composite_init, NULL, &kscan_composite_data, &kscan_composite_config,
                       APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &mock_driver_api);
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "kscan_gpio.h"
+
+#include <device.h>
+#include <logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+int kscan_gpio_list_set_all(const struct kscan_gpio_list *gpios, const int value) {
+    for (int i = 0; i < gpios->len; i++) {
+        const struct device *port = gpios->gpios[i].port;
+        gpio_port_pins_t mask = 0;
+        bool first = true;
+
+        for (int j = 0; j < gpios->len; j++) {
+            if (gpios->gpios[j].port != port) {
+                continue;
+            }
+
+            // Each port is set when its first pin is visited.
+            if (j < i) {
+                first = false;
+                break;
+            }
+
+            mask |= BIT(gpios->gpios[j].pin);
+        }
+
+        if (!first) {
+            continue;
+        }
+
+        int err = gpio_port_set_masked(port, mask, value ? mask : 0);
+        if (err) {
+            LOG_ERR("Failed to set pins 0x%08x on %s to %i: %i", mask, port->name, value, err);
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+void kscan_gpio_port_list_init(struct kscan_gpio_port_list *list,
+                               const struct kscan_gpio_list *inputs) {
+    list->len = 0;
+
+    for (int i = 0; i < inputs->len; i++) {
+        const struct gpio_dt_spec *gpio = &inputs->gpios[i];
+        int p = 0;
+
+        while (p < list->len && list->ports[p].port != gpio->port) {
+            p++;
+        }
+
+        if (p == list->len) {
+            list->ports[p] = (struct kscan_gpio_port){.port = gpio->port};
+            list->len++;
+        }
+
+        list->ports[p].mask |= BIT(gpio->pin);
+        if (gpio->dt_flags & GPIO_ACTIVE_LOW) {
+            list->ports[p].active_low |= BIT(gpio->pin);
+        }
+        list->indices[i] = p;
+    }
+
+    for (int p = 0; p < list->len; p++) {
+        struct kscan_gpio_port *port = &list->ports[p];
+        gpio_port_value_t value;
+
+        // Some drivers, such as for shift registers, can't read a whole port. Fall back to
+        // reading their pins one at a time.
+        port->read_pins = gpio_port_get_raw(port->port, &value) != 0;
+
+        LOG_DBG("Reading inputs 0x%08x on %s %s", port->mask, port->port->name,
+                port->read_pins ? "by pin" : "by port");
+    }
+}
+
+int kscan_gpio_port_list_read(struct kscan_gpio_port_list *list,
+                              const struct kscan_gpio_list *inputs) {
+    for (int p = 0; p < list->len; p++) {
+        struct kscan_gpio_port *port = &list->ports[p];
+
+        if (port->read_pins) {
+            continue;
+        }
+
+        gpio_port_value_t value;
+        int err = gpio_port_get_raw(port->port, &value);
+        if (err) {
+            LOG_ERR("Failed to read port %s: %i", port->port->name, err);
+            return err;
+        }
+
+        port->value = (value ^ port->active_low) & port->mask;
+    }
+
+    for (int i = 0; i < inputs->len; i++) {
+        struct kscan_gpio_port *port = &list->ports[list->indices[i]];
+
+        if (port->read_pins) {
+            const struct gpio_dt_spec *gpio = &inputs->gpios[i];
+            const int value = gpio_pin_get_dt(gpio);
+            if (value < 0) {
+                LOG_ERR("Failed to read pin %u on %s: %i", gpio->pin, gpio->port->name, value);
+                return value;
+            }
+
+            WRITE_BIT(port->value, gpio->pin, value);
+        }
+    }
+
+    return 0;
+}
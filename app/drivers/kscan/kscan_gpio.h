@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <drivers/gpio.h>
+#include <sys/util.h>
+
+struct kscan_gpio_list {
+    const struct gpio_dt_spec *gpios;
+    size_t len;
+};
+
+/** Define a kscan_gpio_list from a compile-time GPIO array. */
+#define KSCAN_GPIO_LIST(gpio_array)                                                                \
+    ((struct kscan_gpio_list){.gpios = gpio_array, .len = ARRAY_SIZE(gpio_array)})
+
+/**
+ * Set the logical value of every GPIO in a list, setting all pins which share a GPIO port with a
+ * single call. This matters for GPIO expanders, where each call is a bus transaction.
+ */
+int kscan_gpio_list_set_all(const struct kscan_gpio_list *gpios, const int value);
+
+/**
+ * Inputs which share a GPIO port, so they can all be read with one call.
+ */
+struct kscan_gpio_port {
+    const struct device *port;
+    /** Pins of the port which are inputs. */
+    gpio_port_pins_t mask;
+    /** Input pins which are active low. */
+    gpio_port_pins_t active_low;
+    /** The port doesn't support reading it as a whole, so read each pin separately. */
+    bool read_pins;
+    /** Logical values of the input pins from the last read. */
+    gpio_port_value_t value;
+};
+
+/**
+ * A list of inputs grouped by the GPIO port they are on.
+ */
+struct kscan_gpio_port_list {
+    /** Array with room for one port per input. */
+    struct kscan_gpio_port *ports;
+    size_t len;
+    /** Array with one entry per input, mapping the input to its index in ports. */
+    uint8_t *indices;
+};
+
+/**
+ * Group a list of inputs, which must already be configured, by GPIO port.
+ */
+void kscan_gpio_port_list_init(struct kscan_gpio_port_list *list,
+                               const struct kscan_gpio_list *inputs);
+
+/**
+ * Read the logical values of all inputs, reading each port with a single call where possible.
+ */
+int kscan_gpio_port_list_read(struct kscan_gpio_port_list *list,
+                              const struct kscan_gpio_list *inputs);
+
+/**
+ * @returns whether an input was active in the last kscan_gpio_port_list_read().
+ */
+static inline bool kscan_gpio_port_list_is_active(const struct kscan_gpio_port_list *list,
+                                                  const struct kscan_gpio_list *inputs,
+                                                  const int input_idx) {
+    const struct kscan_gpio_port *port = &list->ports[list->indices[input_idx]];
+
+    return port->value & BIT(inputs->gpios[input_idx].pin);
+}
@@ -1,251 +1,331 @@
 /*
- * Copyright (c) 2020 The ZMK Contributors
+ * Copyright (c) 2020-2022 The ZMK Contributors
  *
  * SPDX-License-Identifier: MIT
  */
 
-#define DT_DRV_COMPAT zmk_kscan_gpio_demux
+#include "debounce.h"
+#include "kscan_gpio.h"
 
 #include <device.h>
-#include <drivers/kscan.h>
+#include <devicetree.h>
 #include <drivers/gpio.h>
+#include <drivers/kscan.h>
+#include <kernel.h>
 #include <logging/log.h>
+#include <sys/__assert.h>
+#include <sys/util.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
-struct kscan_gpio_item_config {
-    char *label;
-    gpio_pin_t pin;
-    gpio_flags_t flags;
+#define DT_DRV_COMPAT zmk_kscan_gpio_demux
+
+#define INST_INPUTS_LEN(n) DT_INST_PROP_LEN(n, input_gpios)
+#define INST_ADDRESS_LEN(n) DT_INST_PROP_LEN(n, output_gpios)
+#define INST_OUTPUTS_LEN(n) BIT(INST_ADDRESS_LEN(n))
+#define INST_MATRIX_LEN(n) (INST_INPUTS_LEN(n) * INST_OUTPUTS_LEN(n))
+
+#if CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS >= 0
+#define INST_DEBOUNCE_PRESS_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS
+#else
+#define INST_DEBOUNCE_PRESS_MS(n)                                                                  \
+    DT_INST_PROP_OR(n, debounce_period, DT_INST_PROP(n, debounce_press_ms))
+#endif
+
+#if CONFIG_ZMK_KSCAN_DEBOUNCE_RELEASE_MS >= 0
+#define INST_DEBOUNCE_RELEASE_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_RELEASE_MS
+#else
+#define INST_DEBOUNCE_RELEASE_MS(n)                                                                \
+    DT_INST_PROP_OR(n, debounce_period, DT_INST_PROP(n, debounce_release_ms))
+#endif
+
+#define KSCAN_GPIO_INPUT_CFG_INIT(idx, inst_idx)                                                   \
+    GPIO_DT_SPEC_GET_BY_IDX(DT_DRV_INST(inst_idx), input_gpios, idx),
+#define KSCAN_GPIO_OUTPUT_CFG_INIT(idx, inst_idx)                                                  \
+    GPIO_DT_SPEC_GET_BY_IDX(DT_DRV_INST(inst_idx), output_gpios, idx),
+
+struct kscan_demux_data {
+    const struct device *dev;
+    kscan_callback_t callback;
+    struct k_work_delayable work;
+    /** Timestamp of the current or scheduled scan. */
+    int64_t scan_time;
+    /**
+     * Current state of the matrix as a flattened 2D array of length
+     * (config->inputs.len * config->outputs_len).
+     */
+    struct debounce_state *matrix_state;
+    /** The inputs grouped by the GPIO port they are on. */
+    struct kscan_gpio_port_list input_ports;
+    /** The address currently set on the demultiplexer's address lines. */
+    uint32_t address;
 };
 
-// Helper macro
-#define PWR_TWO(x) (1 << (x))
-
-// Define GPIO cfg
-#define _KSCAN_GPIO_ITEM_CFG_INIT(n, prop, idx)                                                    \
-    {                                                                                              \
-        .label = DT_INST_GPIO_LABEL_BY_IDX(n, prop, idx),                                          \
-        .pin = DT_INST_GPIO_PIN_BY_IDX(n, prop, idx),                                              \
-        .flags = DT_INST_GPIO_FLAGS_BY_IDX(n, prop, idx),                                          \
-    },
-
-// Define row and col cfg
-#define _KSCAN_GPIO_INPUT_CFG_INIT(idx, n) _KSCAN_GPIO_ITEM_CFG_INIT(n, input_gpios, idx)
-#define _KSCAN_GPIO_OUTPUT_CFG_INIT(idx, n) _KSCAN_GPIO_ITEM_CFG_INIT(n, output_gpios, idx)
-
-// Check debounce config
-#define CHECK_DEBOUNCE_CFG(n, a, b) COND_CODE_0(DT_INST_PROP(n, debounce_period), a, b)
-
-// Define the row and column lengths
-#define INST_MATRIX_INPUTS(n) DT_INST_PROP_LEN(n, input_gpios)
-#define INST_DEMUX_GPIOS(n) DT_INST_PROP_LEN(n, output_gpios)
-#define INST_MATRIX_OUTPUTS(n) PWR_TWO(INST_DEMUX_GPIOS(n))
-#define POLL_INTERVAL(n) DT_INST_PROP(n, polling_interval_msec)
-
-#define GPIO_INST_INIT(n)                                                                          \
-    struct kscan_gpio_irq_callback_##n {                                                           \
-        struct CHECK_DEBOUNCE_CFG(n, (k_work), (k_work_delayable)) * work;                         \
-        struct gpio_callback callback;                                                             \
-        const struct device *dev;                                                                  \
-    };                                                                                             \
-                                                                                                   \
-    struct kscan_gpio_config_##n {                                                                 \
-        struct kscan_gpio_item_config rows[INST_MATRIX_INPUTS(n)];                                 \
-        struct kscan_gpio_item_config cols[INST_DEMUX_GPIOS(n)];                                   \
-    };                                                                                             \
-                                                                                                   \
-    struct kscan_gpio_data_##n {                                                                   \
-        kscan_callback_t callback;                                                                 \
-        struct k_timer poll_timer;                                                                 \
-        struct CHECK_DEBOUNCE_CFG(n, (k_work), (k_work_delayable)) work;                           \
-        bool matrix_state[INST_MATRIX_INPUTS(n)][INST_MATRIX_OUTPUTS(n)];                          \
-        const struct device *rows[INST_MATRIX_INPUTS(n)];                                          \
-        const struct device *cols[INST_MATRIX_OUTPUTS(n)];                                         \
-        const struct device *dev;                                                                  \
-    };                                                                                             \
-    /* IO/GPIO SETUP */                                                                            \
-    /* gpio_input_devices are PHYSICAL IO devices */                                               \
-    static const struct device **kscan_gpio_input_devices_##n(const struct device *dev) {          \
-        struct kscan_gpio_data_##n *data = dev->data;                                              \
-        return data->rows;                                                                         \
-    }                                                                                              \
-                                                                                                   \
-    static const struct kscan_gpio_item_config *kscan_gpio_input_configs_##n(                      \
-        const struct device *dev) {                                                                \
-        const struct kscan_gpio_config_##n *cfg = dev->config;                                     \
-        return cfg->rows;                                                                          \
-    }                                                                                              \
-                                                                                                   \
-    /* gpio_output_devices are PHYSICAL IO devices */                                              \
-    static const struct device **kscan_gpio_output_devices_##n(const struct device *dev) {         \
-        struct kscan_gpio_data_##n *data = dev->data;                                              \
-        return data->cols;                                                                         \
-    }                                                                                              \
-                                                                                                   \
-    static const struct kscan_gpio_item_config *kscan_gpio_output_configs_##n(                     \
-        const struct device *dev) {                                                                \
-        const struct kscan_gpio_config_##n *cfg = dev->config;                                     \
-        /* If row2col, rows = outputs & cols = inputs */                                           \
-        return cfg->cols;                                                                          \
-    }                                                                                              \
-    /* POLLING SETUP */                                                                            \
-    static void kscan_gpio_timer_handler(struct k_timer *timer) {                                  \
-        struct kscan_gpio_data_##n *data =                                                         \
-            CONTAINER_OF(timer, struct kscan_gpio_data_##n, poll_timer);                           \
-        k_work_submit(&data->work.work);                                                           \
-    }                                                                                              \
-                                                                                                   \
-    /* Read the state of the input GPIOs */                                                        \
-    /* This is the core matrix_scan func */                                                        \
-    static int kscan_gpio_read_##n(const struct device *dev) {                                     \
-        bool submit_follow_up_read = false;                                                        \
-        struct kscan_gpio_data_##n *data = dev->data;                                              \
-        static bool read_state[INST_MATRIX_INPUTS(n)][INST_MATRIX_OUTPUTS(n)];                     \
-        for (int o = 0; o < INST_MATRIX_OUTPUTS(n); o++) {                                         \
-            /* Iterate over bits and set GPIOs accordingly */                                      \
-            for (uint8_t bit = 0; bit < INST_DEMUX_GPIOS(n); bit++) {                              \
-                uint8_t state = (o & (0b1 << bit)) >> bit;                                         \
-                const struct device *out_dev = kscan_gpio_output_devices_##n(dev)[bit];            \
-                const struct kscan_gpio_item_config *out_cfg =                                     \
-                    &kscan_gpio_output_configs_##n(dev)[bit];                                      \
-                gpio_pin_set(out_dev, out_cfg->pin, state);                                        \
-            }                                                                                      \
-            /* Let the col settle before reading the rows */                                       \
-            k_usleep(1);                                                                           \
-                                                                                                   \
-            for (int i = 0; i < INST_MATRIX_INPUTS(n); i++) {                                      \
-                /* Get the input device (port) */                                                  \
-                const struct device *in_dev = kscan_gpio_input_devices_##n(dev)[i];                \
-                /* Get the input device config (pin) */                                            \
-                const struct kscan_gpio_item_config *in_cfg =                                      \
-                    &kscan_gpio_input_configs_##n(dev)[i];                                         \
-                read_state[i][o] = gpio_pin_get(in_dev, in_cfg->pin) > 0;                          \
-            }                                                                                      \
-        }                                                                                          \
-        for (int r = 0; r < INST_MATRIX_INPUTS(n); r++) {                                          \
-            for (int c = 0; c < INST_MATRIX_OUTPUTS(n); c++) {                                     \
-                bool pressed = read_state[r][c];                                                   \
-                submit_follow_up_read = (submit_follow_up_read || pressed);                        \
-                if (pressed != data->matrix_state[r][c]) {                                         \
-                    LOG_DBG("Sending event at %d,%d state %s", r, c, (pressed ? "on" : "off"));    \
-                    data->matrix_state[r][c] = pressed;                                            \
-                    data->callback(dev, r, c, pressed);                                            \
-                }                                                                                  \
-            }                                                                                      \
-        }                                                                                          \
-        if (submit_follow_up_read) {                                                               \
-            CHECK_DEBOUNCE_CFG(n, ({ k_work_submit(&data->work); }),                               \
-                               ({ k_work_reschedule(&data->work, K_MSEC(5)); }))                   \
-        }                                                                                          \
-        return 0;                                                                                  \
-    }                                                                                              \
-                                                                                                   \
-    static void kscan_gpio_work_handler_##n(struct k_work *work) {                                 \
-        struct kscan_gpio_data_##n *data = CONTAINER_OF(work, struct kscan_gpio_data_##n, work);   \
-        kscan_gpio_read_##n(data->dev);                                                            \
-    }                                                                                              \
-                                                                                                   \
-    static struct kscan_gpio_data_##n kscan_gpio_data_##n = {                                      \
-        .rows = {[INST_MATRIX_INPUTS(n) - 1] = NULL}, .cols = {[INST_DEMUX_GPIOS(n) - 1] = NULL}}; \
-                                                                                                   \
-    /* KSCAN API configure function */                                                             \
-    static int kscan_gpio_configure_##n(const struct device *dev, kscan_callback_t callback) {     \
-        LOG_DBG("KSCAN API configure");                                                            \
-        struct kscan_gpio_data_##n *data = dev->data;                                              \
-        if (!callback) {                                                                           \
-            return -EINVAL;                                                                        \
-        }                                                                                          \
-        data->callback = callback;                                                                 \
-        LOG_DBG("Configured GPIO %d", n);                                                          \
-        return 0;                                                                                  \
-    };                                                                                             \
-                                                                                                   \
-    /* KSCAN API enable function */                                                                \
-    static int kscan_gpio_enable_##n(const struct device *dev) {                                   \
-        LOG_DBG("KSCAN API enable");                                                               \
-        struct kscan_gpio_data_##n *data = dev->data;                                              \
-        /* TODO: we might want a follow up to hook into the sleep state hooks in Zephyr, */        \
-        /* and disable this timer when we enter a sleep state */                                   \
-        k_timer_start(&data->poll_timer, K_MSEC(POLL_INTERVAL(n)), K_MSEC(POLL_INTERVAL(n)));      \
-        return 0;                                                                                  \
-    };                                                                                             \
+struct kscan_demux_config {
+    struct kscan_gpio_list inputs;
+    /** The demultiplexer's address lines, least significant bit first. */
+    struct kscan_gpio_list address_lines;
+    /** Number of demultiplexer outputs, which is 2^address_lines.len. */
+    size_t outputs_len;
+    struct debounce_config debounce_config;
+    int32_t debounce_scan_period_ms;
+    int32_t poll_period_ms;
+};
+
+/**
+ * Get the index into a matrix state array from input/output indices.
+ */
+static int state_index_io(const struct kscan_demux_config *config, const int input_idx,
+                          const int output_idx) {
+    __ASSERT(input_idx < config->inputs.len, "Invalid input %i", input_idx);
+    __ASSERT(output_idx < config->outputs_len, "Invalid output %i", output_idx);
+
+    return (output_idx * config->inputs.len) + input_idx;
+}
+
+/**
+ * Select a demultiplexer output, writing only the address lines which change.
+ */
+static int kscan_demux_set_address(const struct device *dev, const uint32_t address) {
+    const struct kscan_demux_config *config = dev->config;
+    struct kscan_demux_data *data = dev->data;
+    const uint32_t changed = address ^ data->address;
+
+    for (int bit = 0; bit < config->address_lines.len; bit++) {
+        if (!(changed & BIT(bit))) {
+            continue;
+        }
+
+        const struct gpio_dt_spec *gpio = &config->address_lines.gpios[bit];
+        int err = gpio_pin_set_dt(gpio, (address & BIT(bit)) != 0);
+        if (err) {
+            LOG_ERR("Failed to set address line %i: %i", bit, err);
+            return err;
+        }
+    }
+
+    data->address = address;
+    return 0;
+}
+
+/**
+ * Send events for keys which changed state.
+ *
+ * @returns whether any key is pressed or still being debounced.
+ */
+static bool kscan_demux_process_keys(const struct device *dev) {
+    const struct kscan_demux_config *config = dev->config;
+    struct kscan_demux_data *data = dev->data;
+    bool continue_scan = false;
+
+    for (int r = 0; r < config->inputs.len; r++) {
+        for (int c = 0; c < config->outputs_len; c++) {
+            struct debounce_state *state = &data->matrix_state[state_index_io(config, r, c)];
+
+            if (debounce_get_changed(state)) {
+                const bool pressed = debounce_is_pressed(state);
+
+                LOG_DBG("Sending event at %i,%i state %s", r, c, pressed ? "on" : "off");
+                data->callback(dev, r, c, pressed);
+            }
+
+            continue_scan = continue_scan || debounce_is_active(state);
+        }
+    }
+
+    return continue_scan;
+}
+
+static int kscan_demux_read(const struct device *dev) {
+    const struct kscan_demux_config *config = dev->config;
+    struct kscan_demux_data *data = dev->data;
+
+    // Visit the outputs in Gray code order, so only one address line changes between outputs.
+    for (int i = 0; i < config->outputs_len; i++) {
+        const uint32_t output = i ^ (i >> 1);
+
+        int err = kscan_demux_set_address(dev, output);
+        if (err) {
+            return err;
+        }
+
+#if CONFIG_ZMK_KSCAN_DEMUX_SETTLE_US > 0
+        // Let the selected output settle before reading the inputs.
+        k_busy_wait(CONFIG_ZMK_KSCAN_DEMUX_SETTLE_US);
+#endif
+
+        err = kscan_gpio_port_list_read(&data->input_ports, &config->inputs);
+        if (err) {
+            return err;
+        }
+
+        for (int input = 0; input < config->inputs.len; input++) {
+            const bool active =
+                kscan_gpio_port_list_is_active(&data->input_ports, &config->inputs, input);
+
+            debounce_update(&data->matrix_state[state_index_io(config, input, output)], active,
+                            config->debounce_scan_period_ms, &config->debounce_config);
+        }
+    }
+
+    if (kscan_demux_process_keys(dev)) {
+        // At least one key is pressed or the debouncer has not yet decided if
+        // it is pressed. Poll quickly until everything is released.
+        data->scan_time += config->debounce_scan_period_ms;
+    } else {
+        // All keys are released. Return to polling slowly.
+        data->scan_time += config->poll_period_ms;
+    }
+
+    k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+
+    return 0;
+}
+
+static void kscan_demux_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = CONTAINER_OF(work, struct k_work_delayable, work);
+    struct kscan_demux_data *data = CONTAINER_OF(dwork, struct kscan_demux_data, work);
+    kscan_demux_read(data->dev);
+}
+
+static int kscan_demux_configure(const struct device *dev, const kscan_callback_t callback) {
+    struct kscan_demux_data *data = dev->data;
+
+    if (!callback) {
+        return -EINVAL;
+    }
+
+    data->callback = callback;
+    return 0;
+}
+
+static int kscan_demux_enable(const struct device *dev) {
+    struct kscan_demux_data *data = dev->data;
+
+    data->scan_time = k_uptime_get();
+
+    // Read will automatically schedule the next scan once done.
+    return kscan_demux_read(dev);
+}
+
+static int kscan_demux_disable(const struct device *dev) {
+    struct kscan_demux_data *data = dev->data;
+
+    k_work_cancel_delayable(&data->work);
+    return 0;
+}
+
+static int kscan_demux_init_inputs(const struct device *dev) {
+    const struct kscan_demux_config *config = dev->config;
+    struct kscan_demux_data *data = dev->data;
+
+    for (int i = 0; i < config->inputs.len; i++) {
+        const struct gpio_dt_spec *gpio = &config->inputs.gpios[i];
+
+        if (!device_is_ready(gpio->port)) {
+            LOG_ERR("GPIO is not ready: %s", gpio->port->name);
+            return -ENODEV;
+        }
+
+        int err = gpio_pin_configure_dt(gpio, GPIO_INPUT);
+        if (err) {
+            LOG_ERR("Unable to configure pin %u on %s for input", gpio->pin, gpio->port->name);
+            return err;
+        }
+
+        LOG_DBG("Configured pin %u on %s for input", gpio->pin, gpio->port->name);
+    }
+
+    // Group the inputs by GPIO port so each port can be read with a single call.
+    kscan_gpio_port_list_init(&data->input_ports, &config->inputs);
+
+    return 0;
+}
+
+static int kscan_demux_init_outputs(const struct device *dev) {
+    const struct kscan_demux_config *config = dev->config;
+    struct kscan_demux_data *data = dev->data;
+
+    for (int i = 0; i < config->address_lines.len; i++) {
+        const struct gpio_dt_spec *gpio = &config->address_lines.gpios[i];
+
+        if (!device_is_ready(gpio->port)) {
+            LOG_ERR("GPIO is not ready: %s", gpio->port->name);
+            return -ENODEV;
+        }
+
+        int err = gpio_pin_configure_dt(gpio, GPIO_OUTPUT_INACTIVE);
+        if (err) {
+            LOG_ERR("Unable to configure pin %u on %s for output", gpio->pin, gpio->port->name);
+            return err;
+        }
+
+        LOG_DBG("Configured pin %u on %s for output", gpio->pin, gpio->port->name);
+    }
+
+    data->address = 0;
+
+    return 0;
+}
+
+static int kscan_demux_init(const struct device *dev) {
+    struct kscan_demux_data *data = dev->data;
+
+    data->dev = dev;
+
+    kscan_demux_init_inputs(dev);
+    kscan_demux_init_outputs(dev);
+
+    k_work_init_delayable(&data->work, kscan_demux_work_handler);
+
+    return 0;
+}
+
+static const struct kscan_driver_api kscan_demux_api = {
+    .config = kscan_demux_configure,
+    .enable_callback = kscan_demux_enable,
+    .disable_callback = kscan_demux_disable,
+};
+
+#define KSCAN_DEMUX_INIT(n)                                                                        \
+    BUILD_ASSERT(INST_DEBOUNCE_PRESS_MS(n) <= DEBOUNCE_COUNTER_MAX,                                \
+                 "ZMK_KSCAN_DEBOUNCE_PRESS_MS or debounce-press-ms is too large");                 \
+    BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
+                 "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
+    BUILD_ASSERT(INST_ADDRESS_LEN(n) <= 8, "Too many demultiplexer address lines");                \
                                                                                                    \
-    /* KSCAN API disable function */                                                               \
-    static int kscan_gpio_disable_##n(const struct device *dev) {                                  \
-        LOG_DBG("KSCAN API disable");                                                              \
-        struct kscan_gpio_data_##n *data = dev->data;                                              \
-        k_timer_stop(&data->poll_timer);                                                           \
-        return 0;                                                                                  \
-    };                                                                                             \
+    static const struct gpio_dt_spec kscan_demux_inputs_##n[] = {                                  \
+        UTIL_LISTIFY(INST_INPUTS_LEN(n), KSCAN_GPIO_INPUT_CFG_INIT, n)};                           \
                                                                                                    \
-    /* GPIO init function*/                                                                        \
-    static int kscan_gpio_init_##n(const struct device *dev) {                                     \
-        LOG_DBG("KSCAN GPIO init");                                                                \
-        struct kscan_gpio_data_##n *data = dev->data;                                              \
-        int err;                                                                                   \
-        /* configure input devices*/                                                               \
-        const struct device **input_devices = kscan_gpio_input_devices_##n(dev);                   \
-        for (int i = 0; i < INST_MATRIX_INPUTS(n); i++) {                                          \
-            const struct kscan_gpio_item_config *in_cfg = &kscan_gpio_input_configs_##n(dev)[i];   \
-            input_devices[i] = device_get_binding(in_cfg->label);                                  \
-            if (!input_devices[i]) {                                                               \
-                LOG_ERR("Unable to find input GPIO device");                                       \
-                return -EINVAL;                                                                    \
-            }                                                                                      \
-            err = gpio_pin_configure(input_devices[i], in_cfg->pin, GPIO_INPUT | in_cfg->flags);   \
-            if (err) {                                                                             \
-                LOG_ERR("Unable to configure pin %d on %s for input", in_cfg->pin, in_cfg->label); \
-                return err;                                                                        \
-            } else {                                                                               \
-                LOG_DBG("Configured pin %d on %s for input", in_cfg->pin, in_cfg->label);          \
-            }                                                                                      \
-            if (err) {                                                                             \
-                LOG_ERR("Error adding the callback to the column device");                         \
-                return err;                                                                        \
-            }                                                                                      \
-        }                                                                                          \
-        /* configure output devices*/                                                              \
-        const struct device **output_devices = kscan_gpio_output_devices_##n(dev);                 \
-        for (int o = 0; o < INST_DEMUX_GPIOS(n); o++) {                                            \
-            const struct kscan_gpio_item_config *out_cfg = &kscan_gpio_output_configs_##n(dev)[o]; \
-            output_devices[o] = device_get_binding(out_cfg->label);                                \
-            if (!output_devices[o]) {                                                              \
-                LOG_ERR("Unable to find output GPIO device");                                      \
-                return -EINVAL;                                                                    \
-            }                                                                                      \
-            err = gpio_pin_configure(output_devices[o], out_cfg->pin,                              \
-                                     GPIO_OUTPUT_ACTIVE | out_cfg->flags);                         \
-            if (err) {                                                                             \
-                LOG_ERR("Unable to configure pin %d on %s for output", out_cfg->pin,               \
-                        out_cfg->label);                                                           \
-                return err;                                                                        \
-            } else {                                                                               \
-                LOG_DBG("Configured pin %d on %s for output", out_cfg->pin, out_cfg->label);       \
-            }                                                                                      \
-        }                                                                                          \
-        data->dev = dev;                                                                           \
+    static const struct gpio_dt_spec kscan_demux_address_lines_##n[] = {                           \
+        UTIL_LISTIFY(INST_ADDRESS_LEN(n), KSCAN_GPIO_OUTPUT_CFG_INIT, n)};                         \
                                                                                                    \
-        k_timer_init(&data->poll_timer, kscan_gpio_timer_handler, NULL);                           \
+    static struct debounce_state kscan_demux_state_##n[INST_MATRIX_LEN(n)];                        \
                                                                                                    \
-        (CHECK_DEBOUNCE_CFG(n, (k_work_init), (k_work_init_delayable)))(                           \
-            &data->work, kscan_gpio_work_handler_##n);                                             \
-        return 0;                                                                                  \
-    }                                                                                              \
+    static struct kscan_gpio_port kscan_demux_ports_##n[INST_INPUTS_LEN(n)];                       \
+    static uint8_t kscan_demux_input_ports_##n[INST_INPUTS_LEN(n)];                                \
                                                                                                    \
-    static const struct kscan_driver_api gpio_driver_api_##n = {                                   \
-        .config = kscan_gpio_configure_##n,                                                        \
-        .enable_callback = kscan_gpio_enable_##n,                                                  \
-        .disable_callback = kscan_gpio_disable_##n,                                                \
+    static struct kscan_demux_data kscan_demux_data_##n = {                                        \
+        .matrix_state = kscan_demux_state_##n,                                                     \
+        .input_ports = {.ports = kscan_demux_ports_##n, .indices = kscan_demux_input_ports_##n},   \
     };                                                                                             \
                                                                                                    \
-    static const struct kscan_gpio_config_##n kscan_gpio_config_##n = {                            \
-        .rows = {UTIL_LISTIFY(INST_MATRIX_INPUTS(n), _KSCAN_GPIO_INPUT_CFG_INIT, n)},              \
-        .cols = {UTIL_LISTIFY(INST_DEMUX_GPIOS(n), _KSCAN_GPIO_OUTPUT_CFG_INIT, n)},               \
+    static const struct kscan_demux_config kscan_demux_config_##n = {                              \
+        .inputs = KSCAN_GPIO_LIST(kscan_demux_inputs_##n),                                         \
+        .address_lines = KSCAN_GPIO_LIST(kscan_demux_address_lines_##n),                           \
+        .outputs_len = INST_OUTPUTS_LEN(n),                                                        \
+        .debounce_config =                                                                         \
+            {                                                                                      \
+                .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
+                .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
+                .eager_press = DT_INST_PROP(n, debounce_eager_press),                              \
+            },                                                                                     \
+        .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
+        .poll_period_ms = DT_INST_PROP(n, polling_interval_msec),                                  \
     };                                                                                             \
                                                                                                    \
-    DEVICE_DT_INST_DEFINE(n, kscan_gpio_init_##n, NULL, &kscan_gpio_data_##n,                      \
-                          &kscan_gpio_config_##n, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY,   \
-                          &gpio_driver_api_##n);
+    DEVICE_DT_INST_DEFINE(n, &kscan_demux_init, NULL, &kscan_demux_data_##n,                       \
+                          &kscan_demux_config_##n, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY,  \
+                          &kscan_demux_api);
 
-DT_INST_FOREACH_STATUS_OKAY(GPIO_INST_INIT)
+DT_INST_FOREACH_STATUS_OKAY(KSCAN_DEMUX_INIT);
@@ -5,6 +5,7 @@
  */
 
 #include "debounce.h"
+#include "kscan_gpio.h"
 
 #include <device.h>
 #include <devicetree.h>
@@ -62,15 +63,6 @@ struct kscan_direct_data {
     struct debounce_state *pin_state;
 };
 
-struct kscan_gpio_list {
-    const struct gpio_dt_spec *gpios;
-    size_t len;
-};
-
-/** Define a kscan_gpio_list from a compile-time GPIO array. */
-#define KSCAN_GPIO_LIST(gpio_array)                                                                \
-    ((struct kscan_gpio_list){.gpios = gpio_array, .len = ARRAY_SIZE(gpio_array)})
-
 struct kscan_direct_config {
     struct kscan_gpio_list inputs;
     struct debounce_config debounce_config;
@@ -343,6 +335,7 @@ static const struct kscan_driver_api kscan_direct_api = {
             {                                                                                      \
                 .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
                 .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
+                .eager_press = DT_INST_PROP(n, debounce_eager_press),                              \
             },                                                                                     \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
         .poll_period_ms = DT_INST_PROP(n, poll_period_ms),                                         \
@@ -5,6 +5,7 @@
  */
 
 #include "debounce.h"
+#include "kscan_gpio.h"
 
 #include <device.h>
 #include <devicetree.h>
@@ -13,6 +14,7 @@
 #include <kernel.h>
 #include <logging/log.h>
 #include <sys/__assert.h>
+#include <sys/math_extras.h>
 #include <sys/util.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
@@ -27,6 +29,12 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #define INST_COLS_LEN(n) DT_INST_PROP_LEN(n, col_gpios)
 #define INST_MATRIX_LEN(n) (INST_ROWS_LEN(n) * INST_COLS_LEN(n))
 #define INST_INPUTS_LEN(n) COND_DIODE_DIR(n, (INST_COLS_LEN(n)), (INST_ROWS_LEN(n)))
+#define INST_OUTPUTS_LEN(n) COND_DIODE_DIR(n, (INST_ROWS_LEN(n)), (INST_COLS_LEN(n)))
+#define INST_INPUT_WORDS(n) DIV_ROUND_UP(INST_INPUTS_LEN(n), DEBOUNCE_WORD_BITS)
+
+#define INST_DEBOUNCE_ENGINE(n) DT_ENUM_IDX(DT_DRV_INST(n), debounce_engine)
+#define COND_DEBOUNCE_ENGINE(n, integrator_code, vertical_counter_code)                            \
+    COND_CODE_0(INST_DEBOUNCE_ENGINE(n), integrator_code, vertical_counter_code)
 
 #if CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS >= 0
 #define INST_DEBOUNCE_PRESS_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS
@@ -64,6 +72,14 @@ struct kscan_matrix_irq_callback {
     struct gpio_callback callback;
 };
 
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_SCAN_TIME_STATS)
+struct kscan_matrix_scan_stats {
+    uint32_t count;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+};
+#endif
+
 struct kscan_matrix_data {
     const struct device *dev;
     kscan_callback_t callback;
@@ -76,26 +92,30 @@ struct kscan_matrix_data {
     int64_t scan_time;
     /**
      * Current state of the matrix as a flattened 2D array of length
-     * (config->rows.len * config->cols.len)
+     * (config->rows.len * config->cols.len), or NULL if the matrix uses word_state.
      */
     struct debounce_state *matrix_state;
+    /**
+     * Current state of the matrix for the vertical counter debouncer, with
+     * config->debounce_words words per output, or NULL if the matrix uses matrix_state.
+     */
+    struct debounce_word_state *word_state;
+    /** The inputs grouped by the GPIO port they are on. */
+    struct kscan_gpio_port_list input_ports;
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_SCAN_TIME_STATS)
+    struct kscan_matrix_scan_stats scan_stats;
+#endif
 };
 
-struct kscan_gpio_list {
-    const struct gpio_dt_spec *gpios;
-    size_t len;
-};
-
-/** Define a kscan_gpio_list from a compile-time GPIO array. */
-#define KSCAN_GPIO_LIST(gpio_array)                                                                \
-    ((struct kscan_gpio_list){.gpios = gpio_array, .len = ARRAY_SIZE(gpio_array)})
-
 struct kscan_matrix_config {
     struct kscan_gpio_list rows;
     struct kscan_gpio_list cols;
     struct kscan_gpio_list inputs;
     struct kscan_gpio_list outputs;
     struct debounce_config debounce_config;
+    struct debounce_word_config debounce_word_config;
+    /** Number of debounce words per output, or 0 to debounce each key separately. */
+    size_t debounce_words;
     int32_t debounce_scan_period_ms;
     int32_t poll_period_ms;
     enum kscan_diode_direction diode_direction;
@@ -124,12 +144,41 @@ static int state_index_io(const struct kscan_matrix_config *config, const int in
 static int kscan_matrix_set_all_outputs(const struct device *dev, const int value) {
     const struct kscan_matrix_config *config = dev->config;
 
-    for (int i = 0; i < config->outputs.len; i++) {
-        const struct gpio_dt_spec *gpio = &config->outputs.gpios[i];
+    return kscan_gpio_list_set_all(&config->outputs, value);
+}
+
+/**
+ * Set the output at index prev inactive and the output at index next active, where either index
+ * may be -1 for no output. If both are on the same port, they are switched with one call.
+ */
+static int kscan_matrix_switch_output(const struct device *dev, const int prev, const int next) {
+    const struct kscan_matrix_config *config = dev->config;
+    const struct gpio_dt_spec *prev_gpio = (prev >= 0) ? &config->outputs.gpios[prev] : NULL;
+    const struct gpio_dt_spec *next_gpio = (next >= 0) ? &config->outputs.gpios[next] : NULL;
+    int err;
 
-        int err = gpio_pin_set_dt(gpio, value);
+    if (prev_gpio && next_gpio && prev_gpio->port == next_gpio->port) {
+        const gpio_port_pins_t mask = BIT(prev_gpio->pin) | BIT(next_gpio->pin);
+
+        err = gpio_port_set_masked(next_gpio->port, mask, BIT(next_gpio->pin));
+        if (err) {
+            LOG_ERR("Failed to switch from output %i to %i: %i", prev, next, err);
+        }
+        return err;
+    }
+
+    if (prev_gpio) {
+        err = gpio_pin_set_dt(prev_gpio, 0);
+        if (err) {
+            LOG_ERR("Failed to set output %i inactive: %i", prev, err);
+            return err;
+        }
+    }
+
+    if (next_gpio) {
+        err = gpio_pin_set_dt(next_gpio, 1);
         if (err) {
-            LOG_ERR("Failed to set output %i to %i: %i", i, value, err);
+            LOG_ERR("Failed to set output %i active: %i", next, err);
             return err;
         }
     }
@@ -221,42 +270,72 @@ static void kscan_matrix_read_end(const struct device *dev) {
 #endif
 }
 
-static int kscan_matrix_read(const struct device *dev) {
-    struct kscan_matrix_data *data = dev->data;
+static bool kscan_matrix_input_is_active(const struct device *dev, const int input_idx) {
     const struct kscan_matrix_config *config = dev->config;
+    const struct kscan_matrix_data *data = dev->data;
 
-    // Scan the matrix.
-    for (int o = 0; o < config->outputs.len; o++) {
-        const struct gpio_dt_spec *out_gpio = &config->outputs.gpios[o];
+    return kscan_gpio_port_list_is_active(&data->input_ports, &config->inputs, input_idx);
+}
 
-        int err = gpio_pin_set_dt(out_gpio, 1);
-        if (err) {
-            LOG_ERR("Failed to set output %i active: %i", o, err);
-            return err;
-        }
+/**
+ * Update the debouncer for each key on an output from the last read of the inputs.
+ */
+static void kscan_matrix_debounce_keys(const struct device *dev, const int output_idx) {
+    const struct kscan_matrix_config *config = dev->config;
+    struct kscan_matrix_data *data = dev->data;
 
-        for (int i = 0; i < config->inputs.len; i++) {
-            const struct gpio_dt_spec *in_gpio = &config->inputs.gpios[i];
+    for (int i = 0; i < config->inputs.len; i++) {
+        const int index = state_index_io(config, i, output_idx);
+        const bool active = kscan_matrix_input_is_active(dev, i);
 
-            const int index = state_index_io(config, i, o);
-            const bool active = gpio_pin_get_dt(in_gpio);
+        debounce_update(&data->matrix_state[index], active, config->debounce_scan_period_ms,
+                        &config->debounce_config);
+    }
+}
 
-            debounce_update(&data->matrix_state[index], active, config->debounce_scan_period_ms,
-                            &config->debounce_config);
-        }
+/**
+ * Update the debouncer for all keys on an output at once from the last read of the inputs.
+ */
+static void kscan_matrix_debounce_words(const struct device *dev, const int output_idx) {
+    const struct kscan_matrix_config *config = dev->config;
+    struct kscan_matrix_data *data = dev->data;
 
-        err = gpio_pin_set_dt(out_gpio, 0);
-        if (err) {
-            LOG_ERR("Failed to set output %i inactive: %i", o, err);
-            return err;
+    for (int w = 0; w < config->debounce_words; w++) {
+        const int first = w * DEBOUNCE_WORD_BITS;
+        const int last = MIN(first + DEBOUNCE_WORD_BITS, config->inputs.len);
+        uint32_t active = 0;
+
+        for (int i = first; i < last; i++) {
+            if (kscan_matrix_input_is_active(dev, i)) {
+                active |= BIT(i - first);
+            }
         }
 
-#if CONFIG_ZMK_KSCAN_MATRIX_WAIT_BETWEEN_OUTPUTS > 0
-        k_busy_wait(CONFIG_ZMK_KSCAN_MATRIX_WAIT_BETWEEN_OUTPUTS);
-#endif
+        debounce_word_update(&data->word_state[(output_idx * config->debounce_words) + w], active,
+                             &config->debounce_word_config);
     }
+}
 
-    // Process the new state.
+static void kscan_matrix_send_event(const struct device *dev, const int input_idx,
+                                    const int output_idx, const bool pressed) {
+    const struct kscan_matrix_config *config = dev->config;
+    struct kscan_matrix_data *data = dev->data;
+
+    const int row = (config->diode_direction == KSCAN_ROW2COL) ? output_idx : input_idx;
+    const int col = (config->diode_direction == KSCAN_ROW2COL) ? input_idx : output_idx;
+
+    LOG_DBG("Sending event at %i,%i state %s", row, col, pressed ? "on" : "off");
+    data->callback(dev, row, col, pressed);
+}
+
+/**
+ * Send events for keys which changed state.
+ *
+ * @returns whether any key is pressed or still being debounced.
+ */
+static bool kscan_matrix_process_keys(const struct device *dev) {
+    const struct kscan_matrix_config *config = dev->config;
+    struct kscan_matrix_data *data = dev->data;
     bool continue_scan = false;
 
     for (int r = 0; r < config->rows.len; r++) {
@@ -275,6 +354,114 @@ static int kscan_matrix_read(const struct device *dev) {
         }
     }
 
+    return continue_scan;
+}
+
+/**
+ * Send events for keys which changed state, visiting only the changed bits of each word.
+ *
+ * @returns whether any key is pressed or still being debounced.
+ */
+static bool kscan_matrix_process_words(const struct device *dev) {
+    const struct kscan_matrix_config *config = dev->config;
+    struct kscan_matrix_data *data = dev->data;
+    bool continue_scan = false;
+
+    for (int o = 0; o < config->outputs.len; o++) {
+        for (int w = 0; w < config->debounce_words; w++) {
+            const struct debounce_word_state *state =
+                &data->word_state[(o * config->debounce_words) + w];
+            const uint32_t pressed = debounce_word_get_pressed(state);
+            uint32_t changed = debounce_word_get_changed(state);
+
+            while (changed) {
+                const int bit = u32_count_trailing_zeros(changed);
+                changed &= changed - 1;
+
+                kscan_matrix_send_event(dev, (w * DEBOUNCE_WORD_BITS) + bit, o,
+                                        pressed & BIT(bit));
+            }
+
+            continue_scan = continue_scan || debounce_word_get_active(state);
+        }
+    }
+
+    return continue_scan;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_SCAN_TIME_STATS)
+static void kscan_matrix_record_scan_time(const struct device *dev, const uint32_t cycles) {
+    struct kscan_matrix_data *data = dev->data;
+    struct kscan_matrix_scan_stats *stats = &data->scan_stats;
+
+    stats->count++;
+    stats->total_cycles += cycles;
+    stats->max_cycles = MAX(stats->max_cycles, cycles);
+
+    if (stats->count == CONFIG_ZMK_KSCAN_MATRIX_SCAN_TIME_STATS_INTERVAL) {
+        LOG_INF("%s scan time: avg %u us, max %u us over %u scans", dev->name,
+                k_cyc_to_us_floor32(stats->total_cycles / stats->count),
+                k_cyc_to_us_floor32(stats->max_cycles), stats->count);
+
+        *stats = (struct kscan_matrix_scan_stats){0};
+    }
+}
+#endif
+
+static int kscan_matrix_read(const struct device *dev) {
+    struct kscan_matrix_data *data = dev->data;
+    const struct kscan_matrix_config *config = dev->config;
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_SCAN_TIME_STATS)
+    const uint32_t start_cycles = k_cycle_get_32();
+#endif
+
+    // Scan the matrix. Without a wait between outputs, each output is set inactive in the same
+    // call that sets the next one active, which halves the writes to GPIO expanders.
+    int err = kscan_matrix_switch_output(dev, -1, 0);
+    if (err) {
+        return err;
+    }
+
+    for (int o = 0; o < config->outputs.len; o++) {
+        err = kscan_gpio_port_list_read(&data->input_ports, &config->inputs);
+        if (err) {
+            return err;
+        }
+
+        if (config->debounce_words > 0) {
+            kscan_matrix_debounce_words(dev, o);
+        } else {
+            kscan_matrix_debounce_keys(dev, o);
+        }
+
+        const int next = (o + 1 < config->outputs.len) ? o + 1 : -1;
+
+#if CONFIG_ZMK_KSCAN_MATRIX_WAIT_BETWEEN_OUTPUTS > 0
+        err = kscan_matrix_switch_output(dev, o, -1);
+        if (err) {
+            return err;
+        }
+
+        k_busy_wait(CONFIG_ZMK_KSCAN_MATRIX_WAIT_BETWEEN_OUTPUTS);
+
+        err = kscan_matrix_switch_output(dev, -1, next);
+#else
+        err = kscan_matrix_switch_output(dev, o, next);
+#endif
+        if (err) {
+            return err;
+        }
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_SCAN_TIME_STATS)
+    kscan_matrix_record_scan_time(dev, k_cycle_get_32() - start_cycles);
+#endif
+
+    // Process the new state.
+    const bool continue_scan = (config->debounce_words > 0) ? kscan_matrix_process_words(dev)
+                                                            : kscan_matrix_process_keys(dev);
+
     if (continue_scan) {
         // At least one key is pressed or the debouncer has not yet decided if
         // it is pressed. Poll quickly until everything is released.
@@ -358,6 +545,7 @@ static int kscan_matrix_init_input_inst(const struct device *dev, const struct g
 
 static int kscan_matrix_init_inputs(const struct device *dev) {
     const struct kscan_matrix_config *config = dev->config;
+    struct kscan_matrix_data *data = dev->data;
 
     for (int i = 0; i < config->inputs.len; i++) {
         const struct gpio_dt_spec *gpio = &config->inputs.gpios[i];
@@ -367,6 +555,9 @@ static int kscan_matrix_init_inputs(const struct device *dev) {
         }
     }
 
+    // Group the inputs by GPIO port so each port can be read with a single call.
+    kscan_gpio_port_list_init(&data->input_ports, &config->inputs);
+
     return 0;
 }
 
@@ -427,6 +618,8 @@ static const struct kscan_driver_api kscan_matrix_api = {
                  "ZMK_KSCAN_DEBOUNCE_PRESS_MS or debounce-press-ms is too large");                 \
     BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
                  "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
+    BUILD_ASSERT(INST_DEBOUNCE_ENGINE(n) == 0 || !DT_INST_PROP(n, debounce_eager_press),           \
+                 "debounce-eager-press requires debounce-engine \"integrator\"");                  \
                                                                                                    \
     static const struct gpio_dt_spec kscan_matrix_rows_##n[] = {                                   \
         UTIL_LISTIFY(INST_ROWS_LEN(n), KSCAN_GPIO_ROW_CFG_INIT, n)};                               \
@@ -434,13 +627,22 @@ static const struct kscan_driver_api kscan_matrix_api = {
     static const struct gpio_dt_spec kscan_matrix_cols_##n[] = {                                   \
         UTIL_LISTIFY(INST_COLS_LEN(n), KSCAN_GPIO_COL_CFG_INIT, n)};                               \
                                                                                                    \
-    static struct debounce_state kscan_matrix_state_##n[INST_MATRIX_LEN(n)];                       \
+    COND_DEBOUNCE_ENGINE(                                                                          \
+        n, (static struct debounce_state kscan_matrix_state_##n[INST_MATRIX_LEN(n)];),             \
+        (static struct debounce_word_state                                                         \
+             kscan_matrix_words_##n[INST_OUTPUTS_LEN(n) * INST_INPUT_WORDS(n)];))                  \
+                                                                                                   \
+    static struct kscan_gpio_port kscan_matrix_ports_##n[INST_INPUTS_LEN(n)];                      \
+    static uint8_t kscan_matrix_input_ports_##n[INST_INPUTS_LEN(n)];                               \
                                                                                                    \
     COND_INTERRUPTS(                                                                               \
         (static struct kscan_matrix_irq_callback kscan_matrix_irqs_##n[INST_INPUTS_LEN(n)];))      \
                                                                                                    \
     static struct kscan_matrix_data kscan_matrix_data_##n = {                                      \
-        .matrix_state = kscan_matrix_state_##n,                                                    \
+        COND_DEBOUNCE_ENGINE(n, (.matrix_state = kscan_matrix_state_##n, ),                        \
+                             (.word_state = kscan_matrix_words_##n, ))                             \
+        .input_ports = {.ports = kscan_matrix_ports_##n,                                           \
+                        .indices = kscan_matrix_input_ports_##n},                                  \
         COND_INTERRUPTS((.irqs = kscan_matrix_irqs_##n, ))};                                       \
                                                                                                    \
     static struct kscan_matrix_config kscan_matrix_config_##n = {                                  \
@@ -454,7 +656,12 @@ static const struct kscan_driver_api kscan_matrix_api = {
             {                                                                                      \
                 .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
                 .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
+                .eager_press = DT_INST_PROP(n, debounce_eager_press),                              \
             },                                                                                     \
+        .debounce_word_config =                                                                    \
+            DEBOUNCE_WORD_CONFIG(INST_DEBOUNCE_PRESS_MS(n), INST_DEBOUNCE_RELEASE_MS(n),           \
+                                 DT_INST_PROP(n, debounce_scan_period_ms)),                        \
+        .debounce_words = COND_DEBOUNCE_ENGINE(n, (0), (INST_INPUT_WORDS(n))),                     \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
         .poll_period_ms = DT_INST_PROP(n, poll_period_ms),                                         \
         .diode_direction = INST_DIODE_DIR(n),                                                      \
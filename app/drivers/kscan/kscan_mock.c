@@ -15,18 +15,98 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #include <dt-bindings/zmk/kscan_mock.h>
 
+#include "debounce.h"
+
+#define INST_DEBOUNCE_ENABLED(n) DT_INST_NODE_HAS_PROP(n, debounce_scan_period_ms)
+#define INST_MATRIX_LEN(n) (DT_INST_PROP(n, rows) * DT_INST_PROP(n, columns))
+
+/**
+ * When debounce-scan-period-ms is set, events change the raw state of a switch instead of
+ * reporting it directly, and the switches are scanned through the debouncer like a real matrix.
+ */
+struct kscan_mock_debounce_config {
+    struct debounce_config debounce_config;
+    int32_t scan_period_ms;
+    uint8_t rows;
+    uint8_t columns;
+    bool exit_after;
+};
+
 struct kscan_mock_data {
     kscan_callback_t callback;
 
     uint32_t event_index;
     struct k_work_delayable work;
     const struct device *dev;
+
+    /** NULL unless the debouncer is simulated. */
+    const struct kscan_mock_debounce_config *debounce;
+    bool *contacts;
+    struct debounce_state *debounce_states;
+    struct k_work_delayable scan_work;
+    bool events_done;
 };
 
+static void kscan_mock_debounce_scan(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct kscan_mock_data *data = CONTAINER_OF(dwork, struct kscan_mock_data, scan_work);
+    const struct kscan_mock_debounce_config *cfg = data->debounce;
+    bool continue_scan = !data->events_done;
+
+    for (int r = 0; r < cfg->rows; r++) {
+        for (int c = 0; c < cfg->columns; c++) {
+            const int index = (r * cfg->columns) + c;
+            struct debounce_state *state = &data->debounce_states[index];
+
+            debounce_update(state, data->contacts[index], cfg->scan_period_ms,
+                            &cfg->debounce_config);
+
+            if (debounce_get_changed(state)) {
+                const bool pressed = debounce_is_pressed(state);
+
+                LOG_DBG("%d,%d %s at %lld ms", r, c, pressed ? "pressed" : "released",
+                        k_uptime_get());
+                data->callback(data->dev, r, c, pressed);
+            }
+
+            continue_scan = continue_scan || debounce_is_active(state) || data->contacts[index];
+        }
+    }
+
+    if (continue_scan) {
+        k_work_schedule(&data->scan_work, K_MSEC(cfg->scan_period_ms));
+    } else if (cfg->exit_after) {
+        LOG_DBG("Exiting");
+        exit(0);
+    }
+}
+
+static void kscan_mock_set_contact(struct kscan_mock_data *data, uint32_t row, uint32_t column,
+                                   bool pressed) {
+    const struct kscan_mock_debounce_config *cfg = data->debounce;
+
+    if (row >= cfg->rows || column >= cfg->columns) {
+        LOG_WRN("Ignoring event for %d,%d outside of the matrix", row, column);
+        return;
+    }
+
+    data->contacts[(row * cfg->columns) + column] = pressed;
+    k_work_schedule(&data->scan_work, K_NO_WAIT);
+}
+
+static void kscan_mock_init_debounce(struct kscan_mock_data *data) {
+    if (data->debounce) {
+        k_work_init_delayable(&data->scan_work, kscan_mock_debounce_scan);
+    }
+}
+
 static int kscan_mock_disable_callback(const struct device *dev) {
     struct kscan_mock_data *data = dev->data;
 
     k_work_cancel_delayable(&data->work);
+    if (data->debounce) {
+        k_work_cancel_delayable(&data->scan_work);
+    }
     return 0;
 }
 
@@ -43,6 +123,22 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
     return 0;
 }
 
+#define KSCAN_MOCK_DEBOUNCE_INIT(n)                                                                \
+    static bool kscan_mock_contacts_##n[INST_MATRIX_LEN(n)];                                       \
+    static struct debounce_state kscan_mock_debounce_states_##n[INST_MATRIX_LEN(n)];               \
+    static const struct kscan_mock_debounce_config kscan_mock_debounce_config_##n = {              \
+        .debounce_config =                                                                         \
+            {                                                                                      \
+                .debounce_press_ms = DT_INST_PROP(n, debounce_press_ms),                           \
+                .debounce_release_ms = DT_INST_PROP(n, debounce_release_ms),                       \
+                .eager_press = DT_INST_PROP(n, debounce_eager_press),                              \
+            },                                                                                     \
+        .scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                                \
+        .rows = DT_INST_PROP(n, rows),                                                             \
+        .columns = DT_INST_PROP(n, columns),                                                       \
+        .exit_after = DT_INST_PROP(n, exit_after),                                                 \
+    };
+
 #define MOCK_INST_INIT(n)                                                                          \
     struct kscan_mock_config_##n {                                                                 \
         uint32_t events[DT_INST_PROP_LEN(n, events)];                                              \
@@ -55,6 +151,9 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
             uint32_t ev = cfg->events[data->event_index];                                          \
             LOG_DBG("delaying next keypress: %d", ZMK_MOCK_MSEC(ev));                              \
             k_work_schedule(&data->work, K_MSEC(ZMK_MOCK_MSEC(ev)));                               \
+        } else if (data->debounce) {                                                               \
+            /* The scan exits once every switch has settled. */                                    \
+            data->events_done = true;                                                              \
         } else if (cfg->exit_after) {                                                              \
             LOG_DBG("Exiting");                                                                    \
             exit(0);                                                                               \
@@ -66,7 +165,12 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
         uint32_t ev = cfg->events[data->event_index];                                              \
         LOG_DBG("ev %u row %d column %d state %d\n", ev, ZMK_MOCK_ROW(ev), ZMK_MOCK_COL(ev),       \
                 ZMK_MOCK_IS_PRESS(ev));                                                            \
-        data->callback(data->dev, ZMK_MOCK_ROW(ev), ZMK_MOCK_COL(ev), ZMK_MOCK_IS_PRESS(ev));      \
+        if (data->debounce) {                                                                      \
+            kscan_mock_set_contact(data, ZMK_MOCK_ROW(ev), ZMK_MOCK_COL(ev),                       \
+                                   ZMK_MOCK_IS_PRESS(ev));                                         \
+        } else {                                                                                   \
+            data->callback(data->dev, ZMK_MOCK_ROW(ev), ZMK_MOCK_COL(ev), ZMK_MOCK_IS_PRESS(ev));  \
+        }                                                                                          \
         kscan_mock_schedule_next_event_##n(data->dev);                                             \
         data->event_index++;                                                                       \
     }                                                                                              \
@@ -74,6 +178,7 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
         struct kscan_mock_data *data = dev->data;                                                  \
         data->dev = dev;                                                                           \
         k_work_init_delayable(&data->work, kscan_mock_work_handler_##n);                           \
+        kscan_mock_init_debounce(data);                                                            \
         return 0;                                                                                  \
     }                                                                                              \
     static int kscan_mock_enable_callback_##n(const struct device *dev) {                          \
@@ -85,7 +190,13 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
         .enable_callback = kscan_mock_enable_callback_##n,                                         \
         .disable_callback = kscan_mock_disable_callback,                                           \
     };                                                                                             \
-    static struct kscan_mock_data kscan_mock_data_##n;                                             \
+    COND_CODE_1(INST_DEBOUNCE_ENABLED(n), (KSCAN_MOCK_DEBOUNCE_INIT(n)), ())                       \
+    static struct kscan_mock_data kscan_mock_data_##n = {                                          \
+        COND_CODE_1(INST_DEBOUNCE_ENABLED(n),                                                      \
+                    (.debounce = &kscan_mock_debounce_config_##n,                                  \
+                     .contacts = kscan_mock_contacts_##n,                                          \
+                     .debounce_states = kscan_mock_debounce_states_##n, ),                         \
+                    ())};                                                                          \
     static const struct kscan_mock_config_##n kscan_mock_config_##n = {                            \
         .events = DT_INST_PROP(n, events), .exit_after = DT_INST_PROP(n, exit_after)};             \
     DEVICE_DT_INST_DEFINE(n, kscan_mock_init_##n, NULL, &kscan_mock_data_##n,                      \
@@ -26,18 +26,13 @@ static int ec11_get_ab_state(const struct device *dev) {
            gpio_pin_get(drv_data->b, drv_cfg->b_pin);
 }
 
-static int ec11_sample_fetch(const struct device *dev, enum sensor_channel chan) {
+int ec11_update_pulses(const struct device *dev) {
     struct ec11_data *drv_data = dev->data;
-    const struct ec11_config *drv_cfg = dev->config;
     uint8_t val;
     int8_t delta;
 
-    __ASSERT_NO_MSG(chan == SENSOR_CHAN_ALL || chan == SENSOR_CHAN_ROTATION);
-
     val = ec11_get_ab_state(dev);
 
-    LOG_DBG("prev: %d, new: %d", drv_data->ab_state, val);
-
     switch (val | (drv_data->ab_state << 2)) {
     case 0b0010:
     case 0b0100:
@@ -56,30 +51,75 @@ static int ec11_sample_fetch(const struct device *dev, enum sensor_channel chan)
         break;
     }
 
-    LOG_DBG("Delta: %d", delta);
-
     drv_data->pulses += delta;
+    drv_data->delta += delta;
     drv_data->ab_state = val;
 
+    return delta;
+}
+
+static int ec11_sample_fetch(const struct device *dev, enum sensor_channel chan) {
+    struct ec11_data *drv_data = dev->data;
+    const struct ec11_config *drv_cfg = dev->config;
+
+    __ASSERT_NO_MSG(chan == SENSOR_CHAN_ALL || chan == SENSOR_CHAN_ROTATION ||
+                    chan == SENSOR_CHAN_RPM);
+
+    k_spinlock_key_t key = k_spin_lock(&drv_data->lock);
+
+#ifndef CONFIG_EC11_TRIGGER
+    ec11_update_pulses(dev);
+#endif
+
+    // With triggers, the pulses are decoded by the GPIO interrupts, so one fetch picks up every
+    // pulse since the previous one.
     drv_data->ticks = drv_data->pulses / drv_cfg->resolution;
-    drv_data->delta = delta;
     drv_data->pulses %= drv_cfg->resolution;
 
+    const int32_t delta = drv_data->delta;
+    drv_data->delta = 0;
+
+    k_spin_unlock(&drv_data->lock, key);
+
+    const int64_t now = k_uptime_get();
+    drv_data->fetch_elapsed_ms = (int32_t)MIN(now - drv_data->fetch_time, INT32_MAX);
+    drv_data->fetch_time = now;
+
+    LOG_DBG("Delta: %d, ticks: %d", delta, drv_data->ticks);
+
     return 0;
 }
 
 static int ec11_channel_get(const struct device *dev, enum sensor_channel chan,
                             struct sensor_value *val) {
     struct ec11_data *drv_data = dev->data;
+    const struct ec11_config *drv_cfg = dev->config;
 
-    if (chan != SENSOR_CHAN_ROTATION) {
-        return -ENOTSUP;
+    switch (chan) {
+    case SENSOR_CHAN_ROTATION:
+        val->val1 = drv_data->ticks;
+        val->val2 = 0;
+        return 0;
+
+    case SENSOR_CHAN_RPM: {
+        if (drv_cfg->steps == 0) {
+            return -ENOTSUP;
+        }
+
+        // Speed of the ticks from the last fetch over the time since the previous fetch, in
+        // millionths of a revolution per minute.
+        const int64_t pulses = (int64_t)drv_data->ticks * drv_cfg->resolution;
+        const int64_t elapsed_ms = MAX(drv_data->fetch_elapsed_ms, 1);
+        const int64_t micro_rpm = pulses * 60000 * 1000000 / (drv_cfg->steps * elapsed_ms);
+
+        val->val1 = micro_rpm / 1000000;
+        val->val2 = micro_rpm % 1000000;
+        return 0;
     }
 
-    val->val1 = drv_data->ticks;
-    val->val2 = drv_data->delta;
-
-    return 0;
+    default:
+        return -ENOTSUP;
+    }
 }
 
 static const struct sensor_driver_api ec11_driver_api = {
@@ -127,6 +167,7 @@ int ec11_init(const struct device *dev) {
 #endif
 
     drv_data->ab_state = ec11_get_ab_state(dev);
+    drv_data->fetch_time = k_uptime_get();
 
     return 0;
 }
@@ -140,7 +181,8 @@ int ec11_init(const struct device *dev) {
         .b_label = DT_INST_GPIO_LABEL(n, b_gpios),                                                 \
         .b_pin = DT_INST_GPIO_PIN(n, b_gpios),                                                     \
         .b_flags = DT_INST_GPIO_FLAGS(n, b_gpios),                                                 \
-        COND_CODE_0(DT_INST_NODE_HAS_PROP(n, resolution), (1), (DT_INST_PROP(n, resolution))),     \
+        .resolution = DT_INST_PROP_OR(n, resolution, 1),                                           \
+        .steps = DT_INST_PROP_OR(n, steps, 0),                                                     \
     };                                                                                             \
     DEVICE_DT_INST_DEFINE(n, ec11_init, NULL, &ec11_data_##n, &ec11_cfg_##n, POST_KERNEL,          \
                           CONFIG_SENSOR_INIT_PRIORITY, &ec11_driver_api);
@@ -20,15 +20,25 @@ struct ec11_config {
     const uint8_t b_flags;
 
     const uint8_t resolution;
+    /** Pulses per revolution, or 0 if unknown. */
+    const uint16_t steps;
 };
 
 struct ec11_data {
     const struct device *a;
     const struct device *b;
     uint8_t ab_state;
-    int8_t pulses;
-    int8_t ticks;
-    int8_t delta;
+    /** Pulses which have not yet been reported as a whole tick. */
+    int32_t pulses;
+    /** Whole ticks reported by the last sample fetch. */
+    int32_t ticks;
+    /** Pulses decoded since the previous sample fetch. */
+    int32_t delta;
+    /** Time of the last sample fetch, and the time elapsed since the one before it. */
+    int64_t fetch_time;
+    int32_t fetch_elapsed_ms;
+    /** Protects the pulse counts, which are updated from the GPIO interrupts. */
+    struct k_spinlock lock;
 
 #ifdef CONFIG_EC11_TRIGGER
     struct gpio_callback a_gpio_cb;
@@ -43,8 +53,10 @@ struct ec11_data {
     struct k_sem gpio_sem;
     struct k_thread thread;
 #elif defined(CONFIG_EC11_TRIGGER_GLOBAL_THREAD)
-    struct k_work work;
+    struct k_work_delayable work;
 #endif
+    /** Time at which the trigger handler last ran. */
+    int64_t report_time;
 
 #endif /* CONFIG_EC11_TRIGGER */
 };
@@ -56,3 +68,10 @@ int ec11_trigger_set(const struct device *dev, const struct sensor_trigger *trig
 
 int ec11_init_interrupt(const struct device *dev);
 #endif
+
+/**
+ * Decode the change in the A/B pins since the last call. Must be called with the lock held.
+ *
+ * @returns the number of pulses turned, which is -1, 0, or 1.
+ */
+int ec11_update_pulses(const struct device *dev);
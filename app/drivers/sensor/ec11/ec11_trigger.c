@@ -8,6 +8,7 @@
 
 #include <device.h>
 #include <drivers/gpio.h>
+#include <stdlib.h>
 #include <sys/util.h>
 #include <kernel.h>
 #include <drivers/sensor.h>
@@ -36,42 +37,52 @@ static inline void setup_int(const struct device *dev, bool enable) {
     }
 }
 
-static void ec11_a_gpio_callback(const struct device *dev, struct gpio_callback *cb,
-                                 uint32_t pins) {
-    struct ec11_data *drv_data = CONTAINER_OF(cb, struct ec11_data, a_gpio_cb);
-
-    LOG_DBG("");
-
-    setup_int(drv_data->dev, false);
-
+static void ec11_schedule_report(struct ec11_data *drv_data) {
 #if defined(CONFIG_EC11_TRIGGER_OWN_THREAD)
     k_sem_give(&drv_data->gpio_sem);
 #elif defined(CONFIG_EC11_TRIGGER_GLOBAL_THREAD)
-    k_work_submit(&drv_data->work);
+    // Scheduling an already scheduled work item does not move it, so every pulse until the
+    // report runs is collected into the same sensor event.
+    k_work_schedule(&drv_data->work,
+                    K_TIMEOUT_ABS_MS(drv_data->report_time + CONFIG_EC11_REPORT_INTERVAL_MS));
 #endif
 }
 
-static void ec11_b_gpio_callback(const struct device *dev, struct gpio_callback *cb,
+static void ec11_gpio_callback_common(const struct device *dev) {
+    struct ec11_data *drv_data = dev->data;
+    const struct ec11_config *drv_cfg = dev->config;
+
+    // Decode every edge as it happens rather than disabling the interrupts until the handler has
+    // run, so no pulses are lost while the encoder is turned quickly.
+    k_spinlock_key_t key = k_spin_lock(&drv_data->lock);
+    ec11_update_pulses(dev);
+    const bool tick = abs(drv_data->pulses) >= drv_cfg->resolution;
+    k_spin_unlock(&drv_data->lock, key);
+
+    if (tick && drv_data->handler) {
+        ec11_schedule_report(drv_data);
+    }
+}
+
+static void ec11_a_gpio_callback(const struct device *dev, struct gpio_callback *cb,
                                  uint32_t pins) {
-    struct ec11_data *drv_data = CONTAINER_OF(cb, struct ec11_data, b_gpio_cb);
+    struct ec11_data *drv_data = CONTAINER_OF(cb, struct ec11_data, a_gpio_cb);
 
-    LOG_DBG("");
+    ec11_gpio_callback_common(drv_data->dev);
+}
 
-    setup_int(drv_data->dev, false);
+static void ec11_b_gpio_callback(const struct device *dev, struct gpio_callback *cb,
+                                 uint32_t pins) {
+    struct ec11_data *drv_data = CONTAINER_OF(cb, struct ec11_data, b_gpio_cb);
 
-#if defined(CONFIG_EC11_TRIGGER_OWN_THREAD)
-    k_sem_give(&drv_data->gpio_sem);
-#elif defined(CONFIG_EC11_TRIGGER_GLOBAL_THREAD)
-    k_work_submit(&drv_data->work);
-#endif
+    ec11_gpio_callback_common(drv_data->dev);
 }
 
 static void ec11_thread_cb(const struct device *dev) {
     struct ec11_data *drv_data = dev->data;
 
+    drv_data->report_time = k_uptime_get();
     drv_data->handler(dev, drv_data->trigger);
-
-    setup_int(dev, true);
 }
 
 #ifdef CONFIG_EC11_TRIGGER_OWN_THREAD
@@ -84,13 +95,18 @@ static void ec11_thread(int dev_ptr, int unused) {
     while (1) {
         k_sem_take(&drv_data->gpio_sem, K_FOREVER);
         ec11_thread_cb(dev);
+
+        // Pulses which arrive while waiting give the semaphore again, and are all reported by the
+        // next handler call.
+        k_sleep(K_TIMEOUT_ABS_MS(drv_data->report_time + CONFIG_EC11_REPORT_INTERVAL_MS));
     }
 }
 #endif
 
 #ifdef CONFIG_EC11_TRIGGER_GLOBAL_THREAD
 static void ec11_work_cb(struct k_work *work) {
-    struct ec11_data *drv_data = CONTAINER_OF(work, struct ec11_data, work);
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct ec11_data *drv_data = CONTAINER_OF(dwork, struct ec11_data, work);
 
     LOG_DBG("");
 
@@ -136,13 +152,13 @@ int ec11_init_interrupt(const struct device *dev) {
     }
 
 #if defined(CONFIG_EC11_TRIGGER_OWN_THREAD)
-    k_sem_init(&drv_data->gpio_sem, 0, UINT_MAX);
+    k_sem_init(&drv_data->gpio_sem, 0, 1);
 
     k_thread_create(&drv_data->thread, drv_data->thread_stack, CONFIG_EC11_THREAD_STACK_SIZE,
                     (k_thread_entry_t)ec11_thread, dev, 0, NULL,
                     K_PRIO_COOP(CONFIG_EC11_THREAD_PRIORITY), 0, K_NO_WAIT);
 #elif defined(CONFIG_EC11_TRIGGER_GLOBAL_THREAD)
-    k_work_init(&drv_data->work, ec11_work_cb);
+    k_work_init_delayable(&drv_data->work, ec11_work_cb);
 #endif
 
     return 0;
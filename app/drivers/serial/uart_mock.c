@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_uart_mock
+
+#include <stdlib.h>
+#include <device.h>
+#include <drivers/uart.h>
+#include <logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+struct uart_mock_config {
+    const uint8_t *rx_data;
+    size_t rx_len;
+    int32_t rx_delay_ms;
+    bool exit_after;
+};
+
+struct uart_mock_data {
+    size_t rx_index;
+};
+
+static int uart_mock_poll_in(const struct device *dev, unsigned char *c) {
+    const struct uart_mock_config *cfg = dev->config;
+    struct uart_mock_data *data = dev->data;
+
+    if (k_uptime_get() < cfg->rx_delay_ms) {
+        return -1;
+    }
+
+    if (data->rx_index < cfg->rx_len) {
+        *c = cfg->rx_data[data->rx_index++];
+        return 0;
+    }
+
+    // The reader has handled the last byte by the time it polls for the next one.
+    if (cfg->exit_after) {
+        LOG_DBG("Exiting");
+        exit(0);
+    }
+
+    return -1;
+}
+
+static void uart_mock_poll_out(const struct device *dev, unsigned char c) {}
+
+static const struct uart_driver_api uart_mock_driver_api = {
+    .poll_in = uart_mock_poll_in,
+    .poll_out = uart_mock_poll_out,
+};
+
+static int uart_mock_init(const struct device *dev) { return 0; }
+
+#define UART_MOCK_INST(n)                                                                          \
+    static const uint8_t uart_mock_rx_data_##n[] = DT_INST_PROP(n, rx_data);                       \
+    static struct uart_mock_data uart_mock_data_##n;                                               \
+    static const struct uart_mock_config uart_mock_config_##n = {                                  \
+        .rx_data = uart_mock_rx_data_##n,                                                          \
+        .rx_len = ARRAY_SIZE(uart_mock_rx_data_##n),                                               \
+        .rx_delay_ms = DT_INST_PROP(n, rx_delay_ms),                                               \
+        .exit_after = DT_INST_PROP(n, exit_after),                                                 \
+    };                                                                                             \
+    DEVICE_DT_INST_DEFINE(n, uart_mock_init, NULL, &uart_mock_data_##n, &uart_mock_config_##n,     \
+                          PRE_KERNEL_1, CONFIG_SERIAL_INIT_PRIORITY, &uart_mock_driver_api);
+
+DT_INST_FOREACH_STATUS_OKAY(UART_MOCK_INST)
@@ -11,6 +11,7 @@
 #include <sys/util.h>
 #include <string.h>
 #include <device.h>
+#include <drivers/sensor.h>
 #include <zmk/keys.h>
 #include <zmk/behavior.h>
 
@@ -26,6 +27,7 @@ typedef int (*behavior_keymap_binding_callback_t)(struct zmk_behavior_binding *b
                                                   struct zmk_behavior_binding_event event);
 typedef int (*behavior_sensor_keymap_binding_callback_t)(struct zmk_behavior_binding *binding,
                                                          const struct device *sensor,
+                                                         struct sensor_value value,
                                                          int64_t timestamp);
 
 enum behavior_locality {
@@ -151,20 +153,23 @@ static inline int z_impl_behavior_keymap_binding_released(struct zmk_behavior_bi
 /**
  * @brief Handle the a sensor keymap binding being triggered
  * @param dev Pointer to the device structure for the driver instance.
- * @param sensor Pointer to the sensor device structure for the sensor driver instance.
- * @param param1 User parameter specified at time of behavior binding.
- * @param param2 User parameter specified at time of behavior binding.
+ * @param sensor Pointer to the sensor device structure for the sensor driver instance, or NULL
+ *               for a sensor on a split peripheral.
+ * @param value Rotation value read from the sensor when it triggered.
+ * @param timestamp Time at which the sensor triggered.
  *
  * @retval 0 If successful.
  * @retval Negative errno code if failure.
  */
 __syscall int behavior_sensor_keymap_binding_triggered(struct zmk_behavior_binding *binding,
                                                        const struct device *sensor,
+                                                       struct sensor_value value,
                                                        int64_t timestamp);
 
 static inline int
 z_impl_behavior_sensor_keymap_binding_triggered(struct zmk_behavior_binding *binding,
-                                                const struct device *sensor, int64_t timestamp) {
+                                                const struct device *sensor,
+                                                struct sensor_value value, int64_t timestamp) {
     const struct device *dev = device_get_binding(binding->behavior_dev);
 
     if (dev == NULL) {
@@ -177,7 +182,7 @@ z_impl_behavior_sensor_keymap_binding_triggered(struct zmk_behavior_binding *bin
         return -ENOTSUP;
     }
 
-    return api->sensor_binding_triggered(binding, sensor, timestamp);
+    return api->sensor_binding_triggered(binding, sensor, value, timestamp);
 }
 
 /**
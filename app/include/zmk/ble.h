@@ -10,7 +10,7 @@
 #include <zmk/ble/profile.h>
 
 #define ZMK_BLE_IS_CENTRAL                                                                         \
-    (IS_ENABLED(CONFIG_ZMK_SPLIT) && IS_ENABLED(CONFIG_ZMK_BLE) &&                                 \
+    (IS_ENABLED(CONFIG_ZMK_SPLIT) && IS_ENABLED(CONFIG_ZMK_SPLIT_BLE) &&                           \
      IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL))
 
 #if ZMK_BLE_IS_CENTRAL
@@ -33,6 +33,8 @@ char *zmk_ble_active_profile_name();
 
 int zmk_ble_unpair_all();
 
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+#if ZMK_BLE_IS_CENTRAL
 void zmk_ble_set_peripheral_addr(bt_addr_le_t *addr);
-#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL) */
+// Returns the address of the last connected peripheral, or NULL if none has been stored.
+const bt_addr_le_t *zmk_ble_get_peripheral_addr();
+#endif /* ZMK_BLE_IS_CENTRAL */
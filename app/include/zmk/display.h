@@ -10,17 +10,32 @@
 
 #pragma once
 
+#include <kernel.h>
+#include <sys/atomic.h>
+
 struct k_work_q *zmk_display_work_q();
 
 bool zmk_display_is_initialized();
 int zmk_display_init();
 
+/**
+ * @brief Redraw the display once the display work queue is free. LVGL only runs when a refresh is
+ * requested or an animation is running, so call this after changing LVGL objects outside of a
+ * ZMK_DISPLAY_WIDGET_LISTENER callback.
+ */
+void zmk_display_request_refresh();
+
 /**
  * @brief Macro to define a ZMK event listener that handles the thread safety of fetching
  * the necessary state from the system work queue context, invoking a work callback
  * in the display queue context, and properly accessing that state safely when performing
  * display/LVGL updates.
  *
+ * Events never block on the display. The state is published with a sequence counter, which is odd
+ * while the state is being written, and the display reads it again if the counter changed while it
+ * was copying the state. Events which arrive before the display has handled the previous one only
+ * replace the state, so they collapse into a single update with the latest state.
+ *
  * @param listener THe ZMK Event manager listener name.
  * @param state_type The struct/enum type used to store/transfer state.
  * @param cb The callback to invoke in the dispaly queue context to update the UI. Should be `void
@@ -31,20 +46,32 @@ int zmk_display_init();
  * once ready to be updated.
  **/
 #define ZMK_DISPLAY_WIDGET_LISTENER(listener, state_type, cb, state_func)                          \
-    K_MUTEX_DEFINE(listener##_mutex);                                                              \
     static state_type __##listener##_state;                                                        \
+    static atomic_t __##listener##_seq;                                                            \
+    static atomic_t __##listener##_pending;                                                        \
+    static struct k_spinlock __##listener##_write_lock;                                            \
     static state_type listener##_get_local_state() {                                               \
-        k_mutex_lock(&listener##_mutex, K_FOREVER);                                                \
-        state_type copy = __##listener##_state;                                                    \
-        k_mutex_unlock(&listener##_mutex);                                                         \
+        state_type copy;                                                                           \
+        atomic_val_t seq;                                                                          \
+        do {                                                                                       \
+            seq = atomic_get(&__##listener##_seq);                                                 \
+            copy = __##listener##_state;                                                           \
+        } while ((seq & 1) || atomic_get(&__##listener##_seq) != seq);                             \
         return copy;                                                                               \
     };                                                                                             \
-    static void listener##_work_cb(struct k_work *work) { cb(listener##_get_local_state()); };     \
+    static void listener##_work_cb(struct k_work *work) {                                          \
+        atomic_clear(&__##listener##_pending);                                                     \
+        cb(listener##_get_local_state());                                                          \
+        zmk_display_request_refresh();                                                             \
+    };                                                                                             \
     K_WORK_DEFINE(listener##_work, listener##_work_cb);                                            \
     static void listener##_refresh_state(const zmk_event_t *eh) {                                  \
-        k_mutex_lock(&listener##_mutex, K_FOREVER);                                                \
-        __##listener##_state = state_func(eh);                                                     \
-        k_mutex_unlock(&listener##_mutex);                                                         \
+        state_type state = state_func(eh);                                                         \
+        k_spinlock_key_t key = k_spin_lock(&__##listener##_write_lock);                            \
+        atomic_inc(&__##listener##_seq);                                                           \
+        __##listener##_state = state;                                                              \
+        atomic_inc(&__##listener##_seq);                                                           \
+        k_spin_unlock(&__##listener##_write_lock, key);                                            \
     };                                                                                             \
     static void listener##_init() {                                                                \
         listener##_refresh_state(NULL);                                                            \
@@ -53,7 +80,9 @@ int zmk_display_init();
     static int listener##_cb(const zmk_event_t *eh) {                                              \
         if (zmk_display_is_initialized()) {                                                        \
             listener##_refresh_state(eh);                                                          \
-            k_work_submit_to_queue(zmk_display_work_q(), &listener##_work);                        \
+            if (!atomic_set(&__##listener##_pending, 1)) {                                         \
+                k_work_submit_to_queue(zmk_display_work_q(), &listener##_work);                    \
+            }                                                                                      \
         }                                                                                          \
         return ZMK_EV_EVENT_BUBBLE;                                                                \
     }                                                                                              \
@@ -9,9 +9,13 @@
 #include <zephyr.h>
 #include <zmk/event_manager.h>
 #include <device.h>
+#include <drivers/sensor.h>
+
 struct zmk_sensor_event {
     uint8_t sensor_number;
+    // NULL for sensors on split peripherals
     const struct device *sensor;
+    struct sensor_value value;
     int64_t timestamp;
 };
 
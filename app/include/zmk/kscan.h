@@ -6,4 +6,17 @@
 
 #pragma once
 
+#include <stdint.h>
+
+struct zmk_kscan_queue_stats {
+    // Most events waiting in the kscan event queue at once.
+    uint32_t high_water;
+    // Events which did not fit in the queue.
+    uint32_t dropped;
+    // Times the key states were resynchronized after events were dropped.
+    uint32_t resyncs;
+};
+
 int zmk_kscan_init(char *name);
+
+void zmk_kscan_get_queue_stats(struct zmk_kscan_queue_stats *stats);
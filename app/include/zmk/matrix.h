@@ -20,7 +20,10 @@
 
 #else /* DT_HAS_CHOSEN(zmk_matrix_transform) */
 
-#if DT_NODE_HAS_PROP(ZMK_MATRIX_NODE_ID, row_gpios)
+#if DT_NODE_HAS_COMPAT(ZMK_MATRIX_NODE_ID, zmk_kscan_74hc165)
+#define ZMK_MATRIX_ROWS DT_PROP_LEN_OR(ZMK_MATRIX_NODE_ID, row_gpios, 1)
+#define ZMK_MATRIX_COLS (DT_PROP(ZMK_MATRIX_NODE_ID, chain_length) * 8)
+#elif DT_NODE_HAS_PROP(ZMK_MATRIX_NODE_ID, row_gpios)
 #define ZMK_MATRIX_ROWS DT_PROP_LEN(ZMK_MATRIX_NODE_ID, row_gpios)
 #define ZMK_MATRIX_COLS DT_PROP_LEN(ZMK_MATRIX_NODE_ID, col_gpios)
 #elif DT_NODE_HAS_PROP(ZMK_MATRIX_NODE_ID, input_gpios)
@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/types.h>
+
+/*
+ * Behaviors under the devicetree `behaviors` node are numbered in devicetree order. Both halves
+ * are built from the same keymap, so they agree on the numbering, and the central can refer to a
+ * behavior by its index instead of its label. The label check guards against halves built from
+ * different sources.
+ */
+
+int zmk_split_behavior_id_for_label(const char *label);
+const char *zmk_split_behavior_label_for_id(uint8_t id);
+uint8_t zmk_split_behavior_label_check(const char *label);
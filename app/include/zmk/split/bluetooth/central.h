@@ -1,8 +1,16 @@
-
 #pragma once
 
 #include <bluetooth/addr.h>
 #include <zmk/behavior.h>
+#include <zmk/split/transport.h>
+
+struct zmk_split_queue_stats {
+    // Most notifications waiting in the central's position event queue at once.
+    uint32_t high_water;
+    // Notifications whose position changes did not fit in the queue.
+    uint32_t dropped;
+    // Times a peripheral's position state was read back after changes were dropped.
+    uint32_t resyncs;
+};
 
-int zmk_split_bt_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
-                                 struct zmk_behavior_binding_event event, bool state);
\ No newline at end of file
+void zmk_split_get_queue_stats(struct zmk_split_queue_stats *stats);
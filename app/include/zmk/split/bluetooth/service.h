@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <zmk/split/transport.h>
+
 #define ZMK_SPLIT_RUN_BEHAVIOR_DEV_LEN 9
 
 struct zmk_split_run_behavior_data {
@@ -20,5 +22,34 @@ struct zmk_split_run_behavior_payload {
     char behavior_dev[ZMK_SPLIT_RUN_BEHAVIOR_DEV_LEN];
 } __packed;
 
-int zmk_split_bt_position_pressed(uint8_t position);
-int zmk_split_bt_position_released(uint8_t position);
\ No newline at end of file
+// Fixed size alternative to `zmk_split_run_behavior_payload` which refers to the behavior by its
+// index in the shared behavior table (see `zmk/split/behavior_ids.h`).
+struct zmk_split_run_behavior_id_payload {
+    struct zmk_split_run_behavior_data data;
+    uint8_t behavior_id;
+    uint8_t behavior_label_check;
+} __packed;
+
+// Notified by the peripheral on every position change. `timestamp` is the lower 32 bits of the
+// peripheral's uptime in milliseconds when the change was captured. Older peripherals only send
+// the `position_state` bitmap.
+struct zmk_split_position_state_payload {
+    uint8_t position_state[ZMK_SPLIT_POS_STATE_LEN];
+    uint32_t timestamp;
+} __packed;
+
+// Fits a default 23 byte ATT MTU notification.
+#define ZMK_SPLIT_SENSOR_DELTAS_MAX 8
+
+struct zmk_split_sensor_delta {
+    uint8_t sensor_number;
+    int8_t delta;
+} __packed;
+
+// Notified by the peripheral with the rotation accumulated by each sensor since the previous
+// notification. Only the first `n` entries of `deltas` are sent, and `timestamp` is the capture
+// time of the oldest accumulated tick, in the same form as the position state payload.
+struct zmk_split_sensor_state_payload {
+    uint32_t timestamp;
+    struct zmk_split_sensor_delta deltas[ZMK_SPLIT_SENSOR_DELTAS_MAX];
+} __packed;
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/types.h>
+#include <zmk/behavior.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE)
+#include <zmk/ble.h>
+#endif
+
+/*
+ * Functions implemented by the selected split transport, see `CONFIG_ZMK_SPLIT_BLE` and
+ * `CONFIG_ZMK_SPLIT_WIRED`.
+ */
+
+#define ZMK_SPLIT_POS_STATE_LEN 16
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE)
+#define ZMK_SPLIT_PERIPHERAL_COUNT ZMK_BLE_SPLIT_PERIPHERAL_COUNT
+#else
+// The wired transport has a single peripheral on the other end of its UART.
+#define ZMK_SPLIT_PERIPHERAL_COUNT 1
+#endif
+
+int zmk_split_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
+                              struct zmk_behavior_binding_event event, bool state);
+
+#else
+
+int zmk_split_position_pressed(uint8_t position, int64_t timestamp);
+int zmk_split_position_released(uint8_t position, int64_t timestamp);
+
+// Forwards `delta` rotation ticks of the keymap sensor `sensor_number` to the central. Ticks
+// which arrive before the previous ones have been sent are accumulated into a single update.
+int zmk_split_sensor_triggered(uint8_t sensor_number, int32_t delta, int64_t timestamp);
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/types.h>
+#include <zmk/split/transport.h>
+
+/*
+ * Messages are sent over the UART in frames of:
+ *
+ *   0xA5 | type | payload length | payload | CRC16-CCITT (little endian)
+ *
+ * with the CRC covering the type, length and payload bytes. Frames failing the CRC are dropped and
+ * the receiver resynchronizes on the next start byte.
+ */
+
+#define ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN 32
+
+enum zmk_split_wired_msg_type {
+    // Peripheral to central
+    ZMK_SPLIT_WIRED_MSG_POSITION_EVENT = 0x01,
+    ZMK_SPLIT_WIRED_MSG_POSITION_STATE = 0x02,
+    ZMK_SPLIT_WIRED_MSG_SENSOR_EVENT = 0x03,
+    // Central to peripheral
+    ZMK_SPLIT_WIRED_MSG_SYNC_REQUEST = 0x10,
+    ZMK_SPLIT_WIRED_MSG_RUN_BEHAVIOR = 0x11,
+    ZMK_SPLIT_WIRED_MSG_RUN_BEHAVIOR_ID = 0x12,
+};
+
+struct zmk_split_wired_position_event {
+    uint8_t position;
+    uint8_t state;
+    // Milliseconds between the position change and the frame being queued for sending.
+    uint16_t age;
+} __packed;
+
+struct zmk_split_wired_position_state {
+    uint8_t position_state[ZMK_SPLIT_POS_STATE_LEN];
+} __packed;
+
+// Rotation accumulated by a sensor since its previous event was sent.
+struct zmk_split_wired_sensor_event {
+    uint8_t sensor_number;
+    int16_t delta;
+    // Milliseconds between the oldest accumulated tick and the frame being queued for sending.
+    uint16_t age;
+} __packed;
+
+struct zmk_split_wired_run_behavior_data {
+    uint8_t position;
+    uint8_t state;
+    uint32_t param1;
+    uint32_t param2;
+} __packed;
+
+// Followed by the behavior label, without a NUL terminator.
+struct zmk_split_wired_run_behavior {
+    struct zmk_split_wired_run_behavior_data data;
+    char behavior_dev[];
+} __packed;
+
+struct zmk_split_wired_run_behavior_id {
+    struct zmk_split_wired_run_behavior_data data;
+    uint8_t behavior_id;
+    uint8_t behavior_label_check;
+} __packed;
+
+int zmk_split_wired_send(enum zmk_split_wired_msg_type type, const void *payload, uint8_t len);
+
+// Microseconds a frame with a payload of `len` bytes spends on the wire.
+uint32_t zmk_split_wired_frame_time_us(uint8_t len);
+
+/*
+ * Implemented by the central or peripheral half. These are called from the system work queue.
+ * `timestamp` is the uptime at which the end of the frame was received.
+ */
+void zmk_split_wired_ready(void);
+void zmk_split_wired_message_received(enum zmk_split_wired_msg_type type, const uint8_t *payload,
+                                      uint8_t len, int64_t timestamp);
+void zmk_split_wired_frame_dropped(void);
@@ -6,6 +6,7 @@
 
 #define DT_DRV_COMPAT zmk_behavior_sensor_rotate_key_press
 
+#include <stdlib.h>
 #include <device.h>
 #include <drivers/behavior.h>
 #include <logging/log.h>
@@ -13,53 +14,213 @@
 #include <drivers/sensor.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/keycode_state_changed.h>
+#include <zmk/sensors.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #if DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
 
-static int behavior_sensor_rotate_key_press_init(const struct device *dev) { return 0; };
-
-static int on_sensor_binding_triggered(struct zmk_behavior_binding *binding,
-                                       const struct device *sensor, int64_t timestamp) {
-    struct sensor_value value;
-    int err;
+// Each sensor binding taps independently. A layer change while an encoder is still tapping uses a
+// second slot for the new layer's binding, so allow two per sensor.
+#if ZMK_KEYMAP_HAS_SENSORS
+#define TAP_SLOTS_LEN (ZMK_KEYMAP_SENSORS_LEN * 2)
+#else
+#define TAP_SLOTS_LEN 1
+#endif
+
+struct behavior_sensor_rotate_key_press_config {
+    /** Speed in ticks per second at which each tick sends two taps, or 0 to disable. */
+    uint16_t acceleration_threshold;
+    /** Maximum number of taps per tick when accelerated. */
+    uint8_t acceleration_max;
+};
+
+struct sensor_rotate_tap_slot {
+    /** Binding which last used this slot, or NULL if the slot has never been used. */
+    const struct zmk_behavior_binding *binding;
+    /** Net number of taps still to send. Positive for param1, negative for param2. */
+    int pending;
+    /** Keycode which is currently pressed, if pressed is set. */
     uint32_t keycode;
-    LOG_DBG("inc keycode 0x%02X dec keycode 0x%02X", binding->param1, binding->param2);
+    bool pressed;
+    /** Timestamp for the next press, or 0 to use the time of the press. */
+    int64_t timestamp;
+    /** Timestamp of the last sensor event for the binding, used to measure its speed. */
+    int64_t event_timestamp;
+    struct k_work_delayable work;
+};
+
+static struct sensor_rotate_tap_slot tap_slots[TAP_SLOTS_LEN];
+
+// Sensors may trigger from their own thread, while taps are sent from the system work queue.
+static struct k_spinlock tap_lock;
+
+static void sensor_rotate_tap_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct sensor_rotate_tap_slot *slot = CONTAINER_OF(dwork, struct sensor_rotate_tap_slot, work);
+    k_spinlock_key_t key = k_spin_lock(&tap_lock);
+
+    if (slot->pressed) {
+        const uint32_t keycode = slot->keycode;
+
+        slot->pressed = false;
+        if (slot->pending != 0) {
+            // Leave a gap before the next press so the host sees separate taps.
+            k_work_schedule(&slot->work, K_MSEC(CONFIG_ZMK_BEHAVIOR_SENSOR_ROTATE_TAP_MS));
+        }
+
+        k_spin_unlock(&tap_lock, key);
+        ZMK_EVENT_RAISE(zmk_keycode_state_changed_from_encoded(keycode, false, k_uptime_get()));
+        return;
+    }
+
+    if (slot->pending == 0) {
+        k_spin_unlock(&tap_lock, key);
+        return;
+    }
+
+    if (slot->pending > 0) {
+        slot->keycode = slot->binding->param1;
+        slot->pending--;
+    } else {
+        slot->keycode = slot->binding->param2;
+        slot->pending++;
+    }
+
+    const uint32_t keycode = slot->keycode;
+    const int64_t timestamp = slot->timestamp ? slot->timestamp : k_uptime_get();
+
+    slot->timestamp = 0;
+    slot->pressed = true;
+    k_work_schedule(&slot->work, K_MSEC(CONFIG_ZMK_BEHAVIOR_SENSOR_ROTATE_TAP_MS));
+
+    k_spin_unlock(&tap_lock, key);
+
+    LOG_DBG("SEND %d", keycode);
+    ZMK_EVENT_RAISE(zmk_keycode_state_changed_from_encoded(keycode, true, timestamp));
+}
+
+static bool tap_slot_is_idle(struct sensor_rotate_tap_slot *slot) {
+    return slot->pending == 0 && !slot->pressed && !k_work_delayable_is_pending(&slot->work);
+}
+
+static struct sensor_rotate_tap_slot *get_tap_slot(const struct zmk_behavior_binding *binding) {
+    struct sensor_rotate_tap_slot *free_slot = NULL;
 
-    err = sensor_channel_get(sensor, SENSOR_CHAN_ROTATION, &value);
+    // Slots keep their binding once idle, so the binding's last event time is still known for
+    // acceleration unless another binding has needed the slot since.
+    for (int i = 0; i < TAP_SLOTS_LEN; i++) {
+        if (tap_slots[i].binding == binding) {
+            return &tap_slots[i];
+        }
 
-    if (err) {
-        LOG_WRN("Failed to ge sensor rotation value: %d", err);
-        return err;
+        if (!free_slot && tap_slot_is_idle(&tap_slots[i])) {
+            free_slot = &tap_slots[i];
+        }
     }
 
-    switch (value.val1) {
-    case 1:
-        keycode = binding->param1;
-        break;
-    case -1:
-        keycode = binding->param2;
-        break;
-    default:
+    if (free_slot) {
+        free_slot->binding = binding;
+        free_slot->pending = 0;
+        free_slot->event_timestamp = 0;
+    }
+
+    return free_slot;
+}
+
+static int accelerate_ticks(const struct behavior_sensor_rotate_key_press_config *cfg,
+                            struct sensor_rotate_tap_slot *slot, int ticks, int64_t timestamp) {
+    const int64_t last_timestamp = slot->event_timestamp;
+
+    slot->event_timestamp = timestamp;
+
+    if (cfg->acceleration_threshold == 0 || last_timestamp == 0) {
+        return ticks;
+    }
+
+    const int64_t elapsed = timestamp - last_timestamp;
+
+    // Sensors report every tick turned since their last report, so the speed is the ticks in this
+    // event over the time since the previous one. Each multiple of the threshold speed adds a tap
+    // per tick.
+    const int64_t speed = (int64_t)abs(ticks) * MSEC_PER_SEC / MAX(elapsed, 1);
+    const int multiplier = CLAMP(speed / cfg->acceleration_threshold + 1, 1, cfg->acceleration_max);
+
+    if (multiplier > 1) {
+        LOG_DBG("Accelerating %d ticks at %lld ticks/s by %d", ticks, speed, multiplier);
+    }
+
+    return ticks * multiplier;
+}
+
+static int behavior_sensor_rotate_key_press_init(const struct device *dev) {
+    static bool initialized;
+
+    if (!initialized) {
+        for (int i = 0; i < TAP_SLOTS_LEN; i++) {
+            k_work_init_delayable(&tap_slots[i].work, sensor_rotate_tap_work_handler);
+        }
+        initialized = true;
+    }
+
+    return 0;
+};
+
+static int on_sensor_binding_triggered(struct zmk_behavior_binding *binding,
+                                       const struct device *sensor, struct sensor_value value,
+                                       int64_t timestamp) {
+    const struct device *dev = device_get_binding(binding->behavior_dev);
+    const struct behavior_sensor_rotate_key_press_config *cfg = dev->config;
+
+    LOG_DBG("inc keycode 0x%02X dec keycode 0x%02X", binding->param1, binding->param2);
+
+    if (value.val1 == 0) {
         return -ENOTSUP;
     }
 
-    LOG_DBG("SEND %d", keycode);
+    k_spinlock_key_t key = k_spin_lock(&tap_lock);
 
-    ZMK_EVENT_RAISE(zmk_keycode_state_changed_from_encoded(keycode, true, timestamp));
+    struct sensor_rotate_tap_slot *slot = get_tap_slot(binding);
+    if (!slot) {
+        k_spin_unlock(&tap_lock, key);
+        LOG_WRN("No free tap slot, dropping %d ticks", value.val1);
+        return -ENOMEM;
+    }
+
+    const bool idle = slot->pending == 0 && !slot->pressed;
+
+    // Events from encoders which batch their reports, or forwarded from split peripherals, may
+    // carry several ticks at once. Ticks which arrive while taps are still being sent are added to
+    // the pending taps, and ticks in the opposite direction cancel them out.
+    slot->pending += accelerate_ticks(cfg, slot, value.val1, timestamp);
+    if (abs(slot->pending) > CONFIG_ZMK_BEHAVIOR_SENSOR_ROTATE_MAX_PENDING_TAPS) {
+        LOG_DBG("Dropping taps beyond %d pending",
+                CONFIG_ZMK_BEHAVIOR_SENSOR_ROTATE_MAX_PENDING_TAPS);
+        slot->pending = (slot->pending > 0) ? CONFIG_ZMK_BEHAVIOR_SENSOR_ROTATE_MAX_PENDING_TAPS
+                                            : -CONFIG_ZMK_BEHAVIOR_SENSOR_ROTATE_MAX_PENDING_TAPS;
+    }
+
+    if (idle) {
+        slot->timestamp = timestamp;
+        k_work_schedule(&slot->work, K_NO_WAIT);
+    }
 
-    // TODO: Better way to do this?
-    k_msleep(5);
+    k_spin_unlock(&tap_lock, key);
 
-    return ZMK_EVENT_RAISE(zmk_keycode_state_changed_from_encoded(keycode, false, timestamp));
+    return 0;
 }
 
 static const struct behavior_driver_api behavior_sensor_rotate_key_press_driver_api = {
     .sensor_binding_triggered = on_sensor_binding_triggered};
 
 #define KP_INST(n)                                                                                 \
-    DEVICE_DT_INST_DEFINE(n, behavior_sensor_rotate_key_press_init, NULL, NULL, NULL, APPLICATION, \
+    static const struct behavior_sensor_rotate_key_press_config                                    \
+        behavior_sensor_rotate_key_press_config_##n = {                                            \
+            .acceleration_threshold = DT_INST_PROP(n, acceleration_threshold),                     \
+            .acceleration_max = DT_INST_PROP(n, acceleration_max),                                 \
+    };                                                                                             \
+    DEVICE_DT_INST_DEFINE(n, behavior_sensor_rotate_key_press_init, NULL, NULL,                    \
+                          &behavior_sensor_rotate_key_press_config_##n, APPLICATION,               \
                           CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,                                     \
                           &behavior_sensor_rotate_key_press_driver_api);
 
@@ -6,6 +6,7 @@
 
 #include <kernel.h>
 #include <init.h>
+#include <sys/atomic.h>
 #include <device.h>
 #include <devicetree.h>
 
@@ -28,12 +29,8 @@ static lv_obj_t *screen;
 
 __attribute__((weak)) lv_obj_t *zmk_display_status_screen() { return NULL; }
 
-void display_tick_cb(struct k_work *work) { lv_task_handler(); }
-
 #define TICK_MS 10
 
-K_WORK_DEFINE(display_tick_work, display_tick_cb);
-
 #if IS_ENABLED(CONFIG_ZMK_DISPLAY_WORK_QUEUE_DEDICATED)
 
 K_THREAD_STACK_DEFINE(display_work_stack_area, CONFIG_ZMK_DISPLAY_DEDICATED_THREAD_STACK_SIZE);
@@ -50,16 +47,70 @@ struct k_work_q *zmk_display_work_q() {
 #endif
 }
 
-void display_timer_cb() {
-    lv_tick_inc(TICK_MS);
-    k_work_submit_to_queue(zmk_display_work_q(), &display_tick_work);
+static atomic_t updates_running;
+static uint32_t last_tick_time;
+
+#if IS_ENABLED(CONFIG_ZMK_DISPLAY_WAKEUP_STATS)
+static uint32_t wakeup_count;
+static uint32_t wakeup_stats_start;
+
+static void record_display_wakeup(uint32_t now) {
+    wakeup_count++;
+
+    // Stats are only logged when the display wakes anyway, so logging adds no wakeups of its own.
+    const uint32_t elapsed = now - wakeup_stats_start;
+    if (elapsed >= CONFIG_ZMK_DISPLAY_WAKEUP_STATS_INTERVAL * MSEC_PER_SEC) {
+        LOG_INF("Display woke %u times in %u ms (%u.%02u per second)", wakeup_count, elapsed,
+                wakeup_count * MSEC_PER_SEC / elapsed,
+                wakeup_count * MSEC_PER_SEC * 100 / elapsed % 100);
+
+        wakeup_count = 0;
+        wakeup_stats_start = now;
+    }
+}
+#endif
+
+static void display_tick_cb(struct k_work *work);
+
+K_WORK_DELAYABLE_DEFINE(display_tick_work, display_tick_cb);
+
+static void display_tick_cb(struct k_work *work) {
+    if (!atomic_get(&updates_running)) {
+        return;
+    }
+
+    const uint32_t now = k_uptime_get_32();
+
+#if IS_ENABLED(CONFIG_ZMK_DISPLAY_WAKEUP_STATS)
+    record_display_wakeup(now);
+#endif
+
+    lv_tick_inc(now - last_tick_time);
+    last_tick_time = now;
+
+    lv_task_handler();
+
+    // LVGL only redraws once its refresh period has passed since the last redraw, which may not
+    // be the case for a second update soon after the first, so redraw the invalidated areas now.
+    lv_refr_now(NULL);
+
+    // Keep running LVGL while animations need new frames. Otherwise sleep until a widget changes.
+    if (lv_anim_count_running() > 0) {
+        k_work_schedule_for_queue(zmk_display_work_q(), &display_tick_work, K_MSEC(TICK_MS));
+    }
+}
+
+void zmk_display_request_refresh() {
+    // While updates are stopped, changes are drawn when they start again.
+    if (atomic_get(&updates_running)) {
+        k_work_reschedule_for_queue(zmk_display_work_q(), &display_tick_work, K_NO_WAIT);
+    }
 }
 
 void blank_display_cb(struct k_work *work) { display_blanking_on(display); }
 
 void unblank_display_cb(struct k_work *work) { display_blanking_off(display); }
 
-K_TIMER_DEFINE(display_timer, display_timer_cb, NULL);
 K_WORK_DEFINE(blank_display_work, blank_display_cb);
 K_WORK_DEFINE(unblank_display_work, unblank_display_cb);
 
@@ -70,7 +121,11 @@ static void start_display_updates() {
 
     k_work_submit_to_queue(zmk_display_work_q(), &unblank_display_work);
 
-    k_timer_start(&display_timer, K_MSEC(TICK_MS), K_MSEC(TICK_MS));
+    if (atomic_set(&updates_running, 1) == 0) {
+        last_tick_time = k_uptime_get_32();
+    }
+
+    zmk_display_request_refresh();
 }
 
 static void stop_display_updates() {
@@ -80,7 +135,8 @@ static void stop_display_updates() {
 
     k_work_submit_to_queue(zmk_display_work_q(), &blank_display_work);
 
-    k_timer_stop(&display_timer);
+    atomic_set(&updates_running, 0);
+    k_work_cancel_delayable(&display_tick_work);
 }
 
 int zmk_display_is_initialized() { return initialized; }
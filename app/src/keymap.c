@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <string.h>
 #include <sys/util.h>
 #include <bluetooth/bluetooth.h>
 #include <logging/log.h>
@@ -15,9 +16,8 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <drivers/behavior.h>
 #include <zmk/behavior.h>
 
-#include <zmk/ble.h>
-#if ZMK_BLE_IS_CENTRAL
-#include <zmk/split/bluetooth/central.h>
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+#include <zmk/split/transport.h>
 #endif
 
 #include <zmk/event_manager.h>
@@ -158,6 +158,21 @@ const char *zmk_keymap_layer_label(uint8_t layer) {
     return zmk_keymap_layer_names[layer];
 }
 
+bool zmk_keymap_position_is_transparent(uint8_t layer, uint32_t position) {
+    if (layer >= ZMK_KEYMAP_LAYERS_LEN || position >= ZMK_KEYMAP_LEN) {
+        return true;
+    }
+
+#if DT_HAS_COMPAT_STATUS_OKAY(zmk_behavior_transparent)
+    const char *behavior_dev = zmk_keymap[layer][position].behavior_dev;
+
+    return behavior_dev == NULL ||
+           strcmp(behavior_dev, DT_LABEL(DT_INST(0, zmk_behavior_transparent))) == 0;
+#else
+    return zmk_keymap[layer][position].behavior_dev == NULL;
+#endif
+}
+
 int invoke_locally(struct zmk_behavior_binding *binding, struct zmk_behavior_binding_event event,
                    bool pressed) {
     if (pressed) {
@@ -206,19 +221,19 @@ int zmk_keymap_apply_position_state(uint8_t source, int layer, uint32_t position
     case BEHAVIOR_LOCALITY_CENTRAL:
         return invoke_locally(&binding, event, pressed);
     case BEHAVIOR_LOCALITY_EVENT_SOURCE:
-#if ZMK_BLE_IS_CENTRAL
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
         if (source == ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL) {
             return invoke_locally(&binding, event, pressed);
         } else {
-            return zmk_split_bt_invoke_behavior(source, &binding, event, pressed);
+            return zmk_split_invoke_behavior(source, &binding, event, pressed);
         }
 #else
         return invoke_locally(&binding, event, pressed);
 #endif
     case BEHAVIOR_LOCALITY_GLOBAL:
-#if ZMK_BLE_IS_CENTRAL
-        for (int i = 0; i < ZMK_BLE_SPLIT_PERIPHERAL_COUNT; i++) {
-            zmk_split_bt_invoke_behavior(i, &binding, event, pressed);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+        for (int i = 0; i < ZMK_SPLIT_PERIPHERAL_COUNT; i++) {
+            zmk_split_invoke_behavior(i, &binding, event, pressed);
         }
 #endif
         return invoke_locally(&binding, event, pressed);
@@ -252,7 +267,12 @@ int zmk_keymap_position_state_changed(uint8_t source, uint32_t position, bool pr
 
 #if ZMK_KEYMAP_HAS_SENSORS
 int zmk_keymap_sensor_triggered(uint8_t sensor_number, const struct device *sensor,
-                                int64_t timestamp) {
+                                struct sensor_value value, int64_t timestamp) {
+    if (sensor_number >= ZMK_KEYMAP_SENSORS_LEN) {
+        LOG_ERR("Sensor number %d is out of range", sensor_number);
+        return -EINVAL;
+    }
+
     for (int layer = ZMK_KEYMAP_LAYERS_LEN - 1; layer >= _zmk_keymap_layer_default; layer--) {
         if (zmk_keymap_layer_active(layer) && zmk_sensor_keymap[layer] != NULL) {
             struct zmk_behavior_binding *binding = &zmk_sensor_keymap[layer][sensor_number];
@@ -269,7 +289,7 @@ int zmk_keymap_sensor_triggered(uint8_t sensor_number, const struct device *sens
                 continue;
             }
 
-            ret = behavior_sensor_keymap_binding_triggered(binding, sensor, timestamp);
+            ret = behavior_sensor_keymap_binding_triggered(binding, sensor, value, timestamp);
 
             if (ret > 0) {
                 LOG_DBG("behavior processing to continue to next layer");
@@ -299,7 +319,7 @@ int keymap_listener(const zmk_event_t *eh) {
     const struct zmk_sensor_event *sensor_ev;
     if ((sensor_ev = as_zmk_sensor_event(eh)) != NULL) {
         return zmk_keymap_sensor_triggered(sensor_ev->sensor_number, sensor_ev->sensor,
-                                           sensor_ev->timestamp);
+                                           sensor_ev->value, sensor_ev->timestamp);
     }
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 
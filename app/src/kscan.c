@@ -9,9 +9,12 @@
 #include <bluetooth/addr.h>
 #include <drivers/kscan.h>
 #include <logging/log.h>
+#include <sys/atomic.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+#include <zmk/kscan.h>
+#include <zmk/matrix.h>
 #include <zmk/matrix_transform.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
@@ -23,25 +26,82 @@ struct zmk_kscan_event {
     uint32_t row;
     uint32_t column;
     uint32_t state;
+    // Kernel uptime in ticks when the driver reported the change. Drivers report changes from
+    // their scan, so this is the scan time, at the resolution of the system timer.
+    int64_t ticks;
 };
 
 struct zmk_kscan_msg_processor {
     struct k_work work;
 } msg_processor;
 
-K_MSGQ_DEFINE(zmk_kscan_msgq, sizeof(struct zmk_kscan_event), CONFIG_ZMK_KSCAN_EVENT_QUEUE_SIZE, 4);
+K_MSGQ_DEFINE(zmk_kscan_msgq, sizeof(struct zmk_kscan_event), CONFIG_ZMK_KSCAN_EVENT_QUEUE_SIZE, 8);
+
+// Key states as last reported by the kscan driver, including changes which did not fit in the
+// queue, and as last raised as position events.
+static ATOMIC_DEFINE(reported_state, ZMK_KEYMAP_LEN);
+static ATOMIC_DEFINE(raised_state, ZMK_KEYMAP_LEN);
+static atomic_t resync_needed;
+
+static struct zmk_kscan_queue_stats queue_stats;
 
 static void zmk_kscan_callback(const struct device *dev, uint32_t row, uint32_t column,
                                bool pressed) {
     struct zmk_kscan_event ev = {
         .row = row,
         .column = column,
-        .state = (pressed ? ZMK_KSCAN_EVENT_STATE_PRESSED : ZMK_KSCAN_EVENT_STATE_RELEASED)};
+        .state = (pressed ? ZMK_KSCAN_EVENT_STATE_PRESSED : ZMK_KSCAN_EVENT_STATE_RELEASED),
+        .ticks = k_uptime_ticks()};
+
+    uint32_t position = zmk_matrix_transform_row_column_to_position(row, column);
+    if (position < ZMK_KEYMAP_LEN) {
+        atomic_set_bit_to(reported_state, position, pressed);
+    }
+
+    if (k_msgq_put(&zmk_kscan_msgq, &ev, K_NO_WAIT) != 0) {
+        // The processor will raise whatever this change was missing once it drains the queue.
+        queue_stats.dropped++;
+        atomic_set(&resync_needed, 1);
+    } else {
+        uint32_t used = k_msgq_num_used_get(&zmk_kscan_msgq);
+        if (used > queue_stats.high_water) {
+            queue_stats.high_water = used;
+        }
+    }
 
-    k_msgq_put(&zmk_kscan_msgq, &ev, K_NO_WAIT);
     k_work_submit(&msg_processor.work);
 }
 
+static void raise_position_state_changed(uint32_t position, bool pressed, int64_t timestamp) {
+    if (position < ZMK_KEYMAP_LEN) {
+        if (atomic_test_bit(raised_state, position) == pressed) {
+            // Already raised by a resync.
+            return;
+        }
+
+        atomic_set_bit_to(raised_state, position, pressed);
+    }
+
+    ZMK_EVENT_RAISE(new_zmk_position_state_changed(
+        (struct zmk_position_state_changed){.source = ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL,
+                                            .state = pressed,
+                                            .position = position,
+                                            .timestamp = timestamp}));
+}
+
+static void resync_position_state(void) {
+    queue_stats.resyncs++;
+    LOG_WRN("Kscan queue overflowed, resyncing key states (%u events dropped, %u resyncs)",
+            queue_stats.dropped, queue_stats.resyncs);
+
+    int64_t timestamp = k_uptime_get();
+
+    for (uint32_t position = 0; position < ZMK_KEYMAP_LEN; position++) {
+        raise_position_state_changed(position, atomic_test_bit(reported_state, position),
+                                     timestamp);
+    }
+}
+
 void zmk_kscan_process_msgq(struct k_work *item) {
     struct zmk_kscan_event ev;
 
@@ -50,14 +110,18 @@ void zmk_kscan_process_msgq(struct k_work *item) {
         uint32_t position = zmk_matrix_transform_row_column_to_position(ev.row, ev.column);
         LOG_DBG("Row: %d, col: %d, position: %d, pressed: %s", ev.row, ev.column, position,
                 (pressed ? "true" : "false"));
-        ZMK_EVENT_RAISE(new_zmk_position_state_changed(
-            (struct zmk_position_state_changed){.source = ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL,
-                                                .state = pressed,
-                                                .position = position,
-                                                .timestamp = k_uptime_get()}));
+        LOG_DBG("Scanned %u us before processing",
+                (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks() - ev.ticks));
+        raise_position_state_changed(position, pressed, k_ticks_to_ms_floor64(ev.ticks));
+    }
+
+    if (atomic_cas(&resync_needed, 1, 0)) {
+        resync_position_state();
     }
 }
 
+void zmk_kscan_get_queue_stats(struct zmk_kscan_queue_stats *stats) { *stats = queue_stats; }
+
 int zmk_kscan_init(char *name) {
     const struct device *dev = device_get_binding(name);
     if (dev == NULL) {
@@ -8,9 +8,10 @@
 #include <init.h>
 #include <kernel.h>
 #include <settings/settings.h>
+#include <sys/atomic.h>
 
-#include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <logging/log.h>
 
@@ -20,9 +21,13 @@
 #include <zmk/rgb_underglow.h>
 
 #include <zmk/activity.h>
+#include <zmk/keymap.h>
+#include <zmk/matrix.h>
 #include <zmk/usb.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/activity_state_changed.h>
+#include <zmk/events/layer_state_changed.h>
+#include <zmk/events/position_state_changed.h>
 #include <zmk/events/usb_conn_state_changed.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
@@ -30,10 +35,18 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #define STRIP_LABEL DT_LABEL(DT_CHOSEN(zmk_underglow))
 #define STRIP_NUM_PIXELS DT_PROP(DT_CHOSEN(zmk_underglow), chain_length)
 
+// Reactive effects need to know which key each LED is under.
+#define UNDERGLOW_HAS_LAYOUT DT_HAS_CHOSEN(zmk_underglow_layout)
+#define UNDERGLOW_HAS_KEYMAP                                                                       \
+    (!IS_ENABLED(CONFIG_ZMK_SPLIT) || IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL))
+
 #define HUE_MAX 360
 #define SAT_MAX 100
 #define BRT_MAX 100
 
+// Colors are converted in 8-bit fixed point, where 255 is full intensity.
+#define CHANNEL_MAX 255
+
 BUILD_ASSERT(CONFIG_ZMK_RGB_UNDERGLOW_BRT_MIN <= CONFIG_ZMK_RGB_UNDERGLOW_BRT_MAX,
              "ERROR: RGB underglow maximum brightness is less than minimum brightness");
 
@@ -42,6 +55,11 @@ enum rgb_underglow_effect {
     UNDERGLOW_EFFECT_BREATHE,
     UNDERGLOW_EFFECT_SPECTRUM,
     UNDERGLOW_EFFECT_SWIRL,
+#if UNDERGLOW_HAS_LAYOUT
+    UNDERGLOW_EFFECT_RIPPLE,
+    UNDERGLOW_EFFECT_HEATMAP,
+    UNDERGLOW_EFFECT_LAYERS,
+#endif
     UNDERGLOW_EFFECT_NUMBER // Used to track number of underglow effects
 };
 
@@ -57,35 +75,92 @@ static const struct device *led_strip;
 
 static struct led_rgb pixels[STRIP_NUM_PIXELS];
 
+// Copy of the last frame sent to the strip. Strip drivers may overwrite the pixels they are given,
+// so each frame is compared against this instead.
+static struct led_rgb last_pixels[STRIP_NUM_PIXELS];
+static bool last_pixels_valid;
+
 static struct rgb_underglow_state state;
 
 #if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_EXT_POWER)
 static const struct device *ext_power;
 #endif
 
-static struct zmk_led_hsb hsb_scale_min_max(struct zmk_led_hsb hsb) {
-    hsb.b = CONFIG_ZMK_RGB_UNDERGLOW_BRT_MIN +
-            (CONFIG_ZMK_RGB_UNDERGLOW_BRT_MAX - CONFIG_ZMK_RGB_UNDERGLOW_BRT_MIN) * hsb.b / BRT_MAX;
-    return hsb;
+#if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_FRAME_TIME_STATS)
+struct rgb_underglow_frame_stats {
+    uint32_t count;
+    uint32_t unchanged;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+};
+
+static struct rgb_underglow_frame_stats frame_stats;
+#endif
+
+// Brightness in percent scaled between the minimum and maximum brightness, or between zero and the
+// maximum brightness, and converted to a channel value.
+static uint8_t brt_lut_min_max[BRT_MAX + 1];
+static uint8_t brt_lut_zero_max[BRT_MAX + 1];
+
+#if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_GAMMA_CORRECTION)
+// Channel values raised to the power of 2.2, so brightness steps look even.
+static const uint8_t gamma_lut[CHANNEL_MAX + 1] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2,
+    3, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10, 11, 11,
+    11, 12, 12, 13, 13, 13, 14, 14, 15, 15, 16, 16, 17, 17, 18, 18, 19, 19, 20, 20, 21, 22, 22, 23,
+    23, 24, 25, 25, 26, 26, 27, 28, 28, 29, 30, 30, 31, 32, 33, 33, 34, 35, 35, 36, 37, 38, 39, 39,
+    40, 41, 42, 43, 43, 44, 45, 46, 47, 48, 49, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61,
+    62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 73, 74, 75, 76, 77, 78, 79, 81, 82, 83, 84, 85, 87, 88,
+    89, 90, 91, 93, 94, 95, 97, 98, 99, 100, 102, 103, 105, 106, 107, 109, 110, 111, 113, 114, 116,
+    117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135, 137, 138, 140, 141, 143, 145,
+    146, 148, 149, 151, 153, 154, 156, 158, 159, 161, 163, 165, 166, 168, 170, 172, 173, 175, 177,
+    179, 181, 182, 184, 186, 188, 190, 192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213,
+    215, 217, 219, 221, 223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253,
+    255};
+#endif
+
+static void brt_lut_init(void) {
+    for (int i = 0; i <= BRT_MAX; i++) {
+        const int min_max =
+            CONFIG_ZMK_RGB_UNDERGLOW_BRT_MIN +
+            (CONFIG_ZMK_RGB_UNDERGLOW_BRT_MAX - CONFIG_ZMK_RGB_UNDERGLOW_BRT_MIN) * i / BRT_MAX;
+        const int zero_max = i * CONFIG_ZMK_RGB_UNDERGLOW_BRT_MAX / BRT_MAX;
+
+        brt_lut_min_max[i] = min_max * CHANNEL_MAX / BRT_MAX;
+        brt_lut_zero_max[i] = zero_max * CHANNEL_MAX / BRT_MAX;
+    }
 }
 
-static struct zmk_led_hsb hsb_scale_zero_max(struct zmk_led_hsb hsb) {
-    hsb.b = hsb.b * CONFIG_ZMK_RGB_UNDERGLOW_BRT_MAX / BRT_MAX;
-    return hsb;
+static inline uint8_t channel_scale(uint8_t value, uint8_t scale) {
+    return ((uint16_t)value * scale + CHANNEL_MAX / 2) / CHANNEL_MAX;
 }
 
-static struct led_rgb hsb_to_rgb(struct zmk_led_hsb hsb) {
-    double r, g, b;
+static inline uint8_t channel_out(uint8_t value) {
+#if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_GAMMA_CORRECTION)
+    return gamma_lut[value];
+#else
+    return value;
+#endif
+}
+
+/**
+ * Convert a hue in degrees and saturation in percent to linear RGB, with a brightness already
+ * converted to a channel value by one of the brightness lookup tables.
+ */
+static struct led_rgb hsb_to_rgb_linear(uint16_t h, uint8_t s, uint8_t brt) {
+    uint8_t r, g, b;
+
+    h %= HUE_MAX;
 
-    uint8_t i = hsb.h / 60;
-    double v = hsb.b / ((float)BRT_MAX);
-    double s = hsb.s / ((float)SAT_MAX);
-    double f = hsb.h / ((float)HUE_MAX) * 6 - i;
-    double p = v * (1 - s);
-    double q = v * (1 - f * s);
-    double t = v * (1 - (1 - f) * s);
+    const uint8_t i = h / 60;
+    const uint8_t v = brt;
+    const uint8_t sat = s * CHANNEL_MAX / SAT_MAX;
+    const uint8_t f = (h % 60) * CHANNEL_MAX / 60;
+    const uint8_t p = channel_scale(v, CHANNEL_MAX - sat);
+    const uint8_t q = channel_scale(v, CHANNEL_MAX - channel_scale(sat, f));
+    const uint8_t t = channel_scale(v, CHANNEL_MAX - channel_scale(sat, CHANNEL_MAX - f));
 
-    switch (i % 6) {
+    switch (i) {
     case 0:
         r = v;
         g = t;
@@ -118,24 +193,31 @@ static struct led_rgb hsb_to_rgb(struct zmk_led_hsb hsb) {
         break;
     }
 
-    struct led_rgb rgb = {r : r * 255, g : g * 255, b : b * 255};
+    struct led_rgb rgb = {r : r, g : g, b : b};
 
     return rgb;
 }
 
-static void zmk_rgb_underglow_effect_solid() {
+static struct led_rgb hsb_to_rgb(uint16_t h, uint8_t s, uint8_t brt) {
+    struct led_rgb rgb = hsb_to_rgb_linear(h, s, brt);
+
+    return (struct led_rgb){r : channel_out(rgb.r), g : channel_out(rgb.g), b : channel_out(rgb.b)};
+}
+
+static void fill_pixels(struct led_rgb rgb) {
     for (int i = 0; i < STRIP_NUM_PIXELS; i++) {
-        pixels[i] = hsb_to_rgb(hsb_scale_min_max(state.color));
+        pixels[i] = rgb;
     }
 }
 
+static void zmk_rgb_underglow_effect_solid() {
+    fill_pixels(hsb_to_rgb(state.color.h, state.color.s, brt_lut_min_max[state.color.b]));
+}
+
 static void zmk_rgb_underglow_effect_breathe() {
-    for (int i = 0; i < STRIP_NUM_PIXELS; i++) {
-        struct zmk_led_hsb hsb = state.color;
-        hsb.b = abs(state.animation_step - 1200) / 12;
+    const uint8_t brt = brt_lut_zero_max[MIN(abs(state.animation_step - 1200) / 12, BRT_MAX)];
 
-        pixels[i] = hsb_to_rgb(hsb_scale_zero_max(hsb));
-    }
+    fill_pixels(hsb_to_rgb(state.color.h, state.color.s, brt));
 
     state.animation_step += state.animation_speed * 10;
 
@@ -145,45 +227,349 @@ static void zmk_rgb_underglow_effect_breathe() {
 }
 
 static void zmk_rgb_underglow_effect_spectrum() {
-    for (int i = 0; i < STRIP_NUM_PIXELS; i++) {
-        struct zmk_led_hsb hsb = state.color;
-        hsb.h = state.animation_step;
-
-        pixels[i] = hsb_to_rgb(hsb_scale_min_max(hsb));
-    }
+    fill_pixels(hsb_to_rgb(state.animation_step, state.color.s, brt_lut_min_max[state.color.b]));
 
     state.animation_step += state.animation_speed;
     state.animation_step = state.animation_step % HUE_MAX;
 }
 
 static void zmk_rgb_underglow_effect_swirl() {
+    const uint8_t brt = brt_lut_min_max[state.color.b];
+
     for (int i = 0; i < STRIP_NUM_PIXELS; i++) {
-        struct zmk_led_hsb hsb = state.color;
-        hsb.h = (HUE_MAX / STRIP_NUM_PIXELS * i + state.animation_step) % HUE_MAX;
+        const uint16_t h = (HUE_MAX / STRIP_NUM_PIXELS * i + state.animation_step) % HUE_MAX;
 
-        pixels[i] = hsb_to_rgb(hsb_scale_min_max(hsb));
+        pixels[i] = hsb_to_rgb(h, state.color.s, brt);
     }
 
     state.animation_step += state.animation_speed * 2;
     state.animation_step = state.animation_step % HUE_MAX;
 }
 
+#if UNDERGLOW_HAS_LAYOUT
+
+#define LAYOUT_NODE DT_CHOSEN(zmk_underglow_layout)
+#define LAYOUT_COLUMNS DT_PROP_OR(LAYOUT_NODE, columns, ZMK_KEYMAP_LEN)
+
+BUILD_ASSERT(DT_PROP_LEN(LAYOUT_NODE, key_positions) == STRIP_NUM_PIXELS,
+             "ERROR: zmk,underglow-layout must have one key position for each LED");
+
+// Time for a ripple to fade out, in milliseconds.
+#define RIPPLE_MS 1000
+// Heat added to a key by each press, out of UINT8_MAX.
+#define HEAT_PER_PRESS 32
+// Hue shift in degrees for each layer above the default layer.
+#define LAYER_HUE_STEP 60
+// Reactive effects blend colors in 8.8 fixed point, where FB_ONE is full intensity.
+#define FB_ONE 256
+
+struct rgb_underglow_ripple {
+    uint32_t position;
+    /** Time of the key press which started the ripple, or 0 if unused. */
+    int64_t start;
+};
+
+struct rgb_underglow_fb_pixel {
+    uint16_t r;
+    uint16_t g;
+    uint16_t b;
+};
+
+// Key position under each LED. LEDs which are not under a key have a position past the end of the
+// keymap.
+static const uint16_t led_key_positions[] = DT_PROP(LAYOUT_NODE, key_positions);
+
+static struct rgb_underglow_fb_pixel framebuffer[STRIP_NUM_PIXELS];
+
+static struct rgb_underglow_ripple ripples[CONFIG_ZMK_RGB_UNDERGLOW_RIPPLES_MAX];
+static uint8_t ripple_next;
+static uint8_t key_heat[ZMK_KEYMAP_LEN];
+
+// Key presses are recorded by the event listener and read when the next frame is drawn.
+static struct k_spinlock reactive_lock;
+
+static void zmk_rgb_underglow_wake_frames();
+
+static void zmk_rgb_underglow_record_press(uint32_t position, int64_t timestamp) {
+    if (position >= ZMK_KEYMAP_LEN) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&reactive_lock);
+
+    ripples[ripple_next] = (struct rgb_underglow_ripple){.position = position, .start = timestamp};
+    ripple_next = (ripple_next + 1) % ARRAY_SIZE(ripples);
+    key_heat[position] = MIN(key_heat[position] + HEAT_PER_PRESS, UINT8_MAX);
+
+    k_spin_unlock(&reactive_lock, key);
+
+    zmk_rgb_underglow_wake_frames();
+}
+
+static bool zmk_rgb_underglow_ripples_active() {
+    const int64_t now = k_uptime_get();
+    bool active = false;
+
+    k_spinlock_key_t key = k_spin_lock(&reactive_lock);
+    for (int i = 0; i < ARRAY_SIZE(ripples); i++) {
+        if (ripples[i].start != 0 && now - ripples[i].start < RIPPLE_MS) {
+            active = true;
+            break;
+        }
+    }
+    k_spin_unlock(&reactive_lock, key);
+
+    return active;
+}
+
+static bool zmk_rgb_underglow_keys_hot() {
+    bool hot = false;
+
+    k_spinlock_key_t key = k_spin_lock(&reactive_lock);
+    for (int i = 0; i < ZMK_KEYMAP_LEN; i++) {
+        if (key_heat[i] > 0) {
+            hot = true;
+            break;
+        }
+    }
+    k_spin_unlock(&reactive_lock, key);
+
+    return hot;
+}
+
+static inline bool led_has_key(int led) { return led_key_positions[led] < ZMK_KEYMAP_LEN; }
+
+static int key_distance(uint32_t a, uint32_t b) {
+    const int rows = abs((int)(a / LAYOUT_COLUMNS) - (int)(b / LAYOUT_COLUMNS));
+    const int cols = abs((int)(a % LAYOUT_COLUMNS) - (int)(b % LAYOUT_COLUMNS));
+
+    return MAX(rows, cols);
+}
+
+static void fb_add(int led, struct led_rgb color, uint16_t intensity) {
+    struct rgb_underglow_fb_pixel *px = &framebuffer[led];
+
+    // A full intensity channel is CHANNEL_MAX * FB_ONE, so overlapping effects saturate.
+    px->r = MIN(px->r + color.r * intensity, UINT16_MAX);
+    px->g = MIN(px->g + color.g * intensity, UINT16_MAX);
+    px->b = MIN(px->b + color.b * intensity, UINT16_MAX);
+}
+
+static void fb_output() {
+    for (int i = 0; i < STRIP_NUM_PIXELS; i++) {
+        pixels[i] = (struct led_rgb){
+            r : channel_out(framebuffer[i].r / FB_ONE),
+            g : channel_out(framebuffer[i].g / FB_ONE),
+            b : channel_out(framebuffer[i].b / FB_ONE),
+        };
+    }
+}
+
+static void zmk_rgb_underglow_effect_ripple() {
+    const uint32_t start_cycles = k_cycle_get_32();
+    const uint32_t budget_cycles = k_us_to_cyc_ceil32(CONFIG_ZMK_RGB_UNDERGLOW_FRAME_BUDGET_US);
+    const struct led_rgb color =
+        hsb_to_rgb_linear(state.color.h, state.color.s, brt_lut_min_max[state.color.b]);
+    const int64_t now = k_uptime_get();
+    struct rgb_underglow_ripple active[ARRAY_SIZE(ripples)];
+    uint8_t newest;
+
+    k_spinlock_key_t key = k_spin_lock(&reactive_lock);
+    memcpy(active, ripples, sizeof(ripples));
+    newest = ripple_next;
+    k_spin_unlock(&reactive_lock, key);
+
+    memset(framebuffer, 0, sizeof(framebuffer));
+
+    // Draw the newest ripples first, so the oldest and faintest are dropped if the frame runs over
+    // its budget.
+    for (int n = 1; n <= ARRAY_SIZE(active); n++) {
+        const struct rgb_underglow_ripple *ripple =
+            &active[(newest + ARRAY_SIZE(active) - n) % ARRAY_SIZE(active)];
+        const int64_t age = now - ripple->start;
+
+        if (ripple->start == 0 || age < 0 || age >= RIPPLE_MS) {
+            continue;
+        }
+
+        if (k_cycle_get_32() - start_cycles > budget_cycles) {
+            LOG_DBG("Underglow frame over budget, dropping %d older ripples",
+                    (int)ARRAY_SIZE(active) - n + 1);
+            break;
+        }
+
+        // The ring spreads at 4 keys per second for each step of animation speed, and fades out
+        // over its lifetime. Distances are in keys scaled by FB_ONE.
+        const int32_t radius = age * state.animation_speed * 4 * FB_ONE / MSEC_PER_SEC;
+        const int32_t fade = RIPPLE_MS - age;
+
+        for (int i = 0; i < STRIP_NUM_PIXELS; i++) {
+            if (!led_has_key(i)) {
+                continue;
+            }
+
+            const int32_t dist = key_distance(led_key_positions[i], ripple->position) * FB_ONE;
+            const int32_t diff = abs(dist - radius);
+
+            if (diff < FB_ONE) {
+                fb_add(i, color, (FB_ONE - diff) * fade / RIPPLE_MS);
+            }
+        }
+    }
+
+    fb_output();
+}
+
+static void zmk_rgb_underglow_effect_heatmap() {
+    const uint8_t brt = brt_lut_min_max[state.color.b];
+    // Keys cool by one step every (6 - speed) frames, so at 50 ms frames a key at full heat cools
+    // in about 13 seconds at speed 5, up to 64 seconds at speed 1.
+    const bool cool = (state.animation_step++ % (6 - state.animation_speed)) == 0;
+    uint8_t heat[ZMK_KEYMAP_LEN];
+
+    k_spinlock_key_t key = k_spin_lock(&reactive_lock);
+    for (int i = 0; i < ZMK_KEYMAP_LEN; i++) {
+        if (cool && key_heat[i] > 0) {
+            key_heat[i]--;
+        }
+        heat[i] = key_heat[i];
+    }
+    k_spin_unlock(&reactive_lock, key);
+
+    // Cold keys are blue, and turn red as they are pressed more.
+    for (int i = 0; i < STRIP_NUM_PIXELS; i++) {
+        if (!led_has_key(i)) {
+            pixels[i] = (struct led_rgb){r : 0, g : 0, b : 0};
+            continue;
+        }
+
+        const uint16_t h = 240 - heat[led_key_positions[i]] * 240 / UINT8_MAX;
+
+        pixels[i] = hsb_to_rgb(h, state.color.s, brt);
+    }
+}
+
+static void zmk_rgb_underglow_effect_layers() {
+#if UNDERGLOW_HAS_KEYMAP
+    const uint8_t layer = zmk_keymap_highest_layer_active();
+    const bool base = layer == zmk_keymap_layer_default();
+#else
+    // Split peripherals don't know the active layer, so always show the base layer.
+    const uint8_t layer = 0;
+    const bool base = true;
+#endif
+    const struct led_rgb color = hsb_to_rgb(state.color.h + layer * LAYER_HUE_STEP, state.color.s,
+                                            brt_lut_min_max[state.color.b]);
+
+    // Above the default layer, only light the keys which the layer binds.
+    for (int i = 0; i < STRIP_NUM_PIXELS; i++) {
+        bool lit = led_has_key(i);
+
+#if UNDERGLOW_HAS_KEYMAP
+        lit = lit && (base || !zmk_keymap_position_is_transparent(layer, led_key_positions[i]));
+#endif
+
+        pixels[i] = lit ? color : (struct led_rgb){r : 0, g : 0, b : 0};
+    }
+}
+
+#endif // UNDERGLOW_HAS_LAYOUT
+
+#if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_FRAME_TIME_STATS)
+static void zmk_rgb_underglow_record_frame_time(const uint32_t cycles, const bool changed) {
+    frame_stats.count++;
+    frame_stats.unchanged += changed ? 0 : 1;
+    frame_stats.total_cycles += cycles;
+    frame_stats.max_cycles = MAX(frame_stats.max_cycles, cycles);
+
+    if (frame_stats.count == CONFIG_ZMK_RGB_UNDERGLOW_FRAME_TIME_STATS_INTERVAL) {
+        LOG_INF("Underglow frame time: avg %u us, max %u us over %u frames, %u unchanged",
+                k_cyc_to_us_floor32(frame_stats.total_cycles / frame_stats.count),
+                k_cyc_to_us_floor32(frame_stats.max_cycles), frame_stats.count,
+                frame_stats.unchanged);
+
+        frame_stats = (struct rgb_underglow_frame_stats){0};
+    }
+}
+#endif
+
+// Time between rewrites of the strip for effects which don't animate, in milliseconds.
+#define STATIC_REFRESH_MS 1000
+
+struct rgb_underglow_effect_info {
+    void (*draw)(void);
+    /** Time between frames in milliseconds, or 0 if the effect only changes with its settings. */
+    uint16_t frame_ms;
+    /**
+     * Whether the effect is still changing, for effects which only animate after key presses, or
+     * NULL if it always animates.
+     */
+    bool (*animating)(void);
+};
+
+static const struct rgb_underglow_effect_info effects[] = {
+    [UNDERGLOW_EFFECT_SOLID] = {.draw = zmk_rgb_underglow_effect_solid, .frame_ms = 0},
+    [UNDERGLOW_EFFECT_BREATHE] = {.draw = zmk_rgb_underglow_effect_breathe, .frame_ms = 50},
+    [UNDERGLOW_EFFECT_SPECTRUM] = {.draw = zmk_rgb_underglow_effect_spectrum, .frame_ms = 50},
+    [UNDERGLOW_EFFECT_SWIRL] = {.draw = zmk_rgb_underglow_effect_swirl, .frame_ms = 50},
+#if UNDERGLOW_HAS_LAYOUT
+    [UNDERGLOW_EFFECT_RIPPLE] = {.draw = zmk_rgb_underglow_effect_ripple,
+                                 .frame_ms = 20,
+                                 .animating = zmk_rgb_underglow_ripples_active},
+    [UNDERGLOW_EFFECT_HEATMAP] = {.draw = zmk_rgb_underglow_effect_heatmap,
+                                  .frame_ms = 50,
+                                  .animating = zmk_rgb_underglow_keys_hot},
+    [UNDERGLOW_EFFECT_LAYERS] = {.draw = zmk_rgb_underglow_effect_layers, .frame_ms = 0},
+#endif
+};
+
+BUILD_ASSERT(ARRAY_SIZE(effects) == UNDERGLOW_EFFECT_NUMBER,
+             "ERROR: RGB underglow effect list does not match the effect enum");
+
+// Set while the frame timer only runs for the slow refresh.
+static atomic_t frames_idle;
+
+static void zmk_rgb_underglow_start_frames();
+static void zmk_rgb_underglow_idle_frames();
+
 static void zmk_rgb_underglow_tick(struct k_work *work) {
-    switch (state.current_effect) {
-    case UNDERGLOW_EFFECT_SOLID:
-        zmk_rgb_underglow_effect_solid();
-        break;
-    case UNDERGLOW_EFFECT_BREATHE:
-        zmk_rgb_underglow_effect_breathe();
-        break;
-    case UNDERGLOW_EFFECT_SPECTRUM:
-        zmk_rgb_underglow_effect_spectrum();
-        break;
-    case UNDERGLOW_EFFECT_SWIRL:
-        zmk_rgb_underglow_effect_swirl();
-        break;
+    if (!state.on || state.current_effect >= UNDERGLOW_EFFECT_NUMBER) {
+        return;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_FRAME_TIME_STATS)
+    const uint32_t start_cycles = k_cycle_get_32();
+#endif
+
+    const struct rgb_underglow_effect_info *effect = &effects[state.current_effect];
+
+    effect->draw();
+
+    // Reactive effects drop to the slow refresh once nothing is left fading, until the next press.
+    const bool animating =
+        effect->frame_ms > 0 && (effect->animating == NULL || effect->animating());
+    if (!animating) {
+        zmk_rgb_underglow_idle_frames();
+    }
+
+    // Every update shifts the whole strip out, so skip frames where no pixel changed. Frames which
+    // don't animate only tick for the slow refresh, which always rewrites the strip in case it lost
+    // power, e.g. through &ext_power, and with it the pixels last written.
+    const bool changed =
+        !animating || !last_pixels_valid || memcmp(pixels, last_pixels, sizeof(pixels)) != 0;
+
+#if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_FRAME_TIME_STATS)
+    // Only the effect is measured, since the strip update time depends on the strip driver.
+    zmk_rgb_underglow_record_frame_time(k_cycle_get_32() - start_cycles, changed);
+#endif
+
+    if (!changed) {
+        return;
     }
 
+    memcpy(last_pixels, pixels, sizeof(pixels));
+    last_pixels_valid = true;
+
     led_strip_update_rgb(led_strip, pixels, STRIP_NUM_PIXELS);
 }
 
@@ -199,6 +585,50 @@ static void zmk_rgb_underglow_tick_handler(struct k_timer *timer) {
 
 K_TIMER_DEFINE(underglow_tick, zmk_rgb_underglow_tick_handler, NULL);
 
+static void zmk_rgb_underglow_start_frames() {
+    if (state.current_effect >= UNDERGLOW_EFFECT_NUMBER) {
+        return;
+    }
+
+    const uint16_t frame_ms = effects[state.current_effect].frame_ms;
+
+    // Static effects draw one frame now, then redraw when their settings change and otherwise only
+    // refresh the strip occasionally.
+    atomic_set(&frames_idle, frame_ms == 0);
+    k_timer_start(&underglow_tick, K_NO_WAIT, K_MSEC(frame_ms > 0 ? frame_ms : STATIC_REFRESH_MS));
+}
+
+static void zmk_rgb_underglow_idle_frames() {
+    if (atomic_set(&frames_idle, 1)) {
+        return;
+    }
+
+    k_timer_start(&underglow_tick, K_MSEC(STATIC_REFRESH_MS), K_MSEC(STATIC_REFRESH_MS));
+
+    // A press recorded after the effect was checked saw the frames still running, so wake them
+    // here instead of leaving it for the next refresh.
+    const struct rgb_underglow_effect_info *effect = &effects[state.current_effect];
+    if (effect->animating != NULL && effect->animating()) {
+        zmk_rgb_underglow_start_frames();
+    }
+}
+
+#if UNDERGLOW_HAS_LAYOUT
+static void zmk_rgb_underglow_wake_frames() {
+    if (state.current_effect < UNDERGLOW_EFFECT_NUMBER &&
+        effects[state.current_effect].animating != NULL && atomic_get(&frames_idle)) {
+        zmk_rgb_underglow_start_frames();
+    }
+}
+#endif
+
+static void zmk_rgb_underglow_redraw() {
+    if (state.on && state.current_effect < UNDERGLOW_EFFECT_NUMBER &&
+        effects[state.current_effect].frame_ms == 0) {
+        k_work_submit(&underglow_work);
+    }
+}
+
 #if IS_ENABLED(CONFIG_SETTINGS)
 static int rgb_settings_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg) {
     const char *next;
@@ -238,6 +668,8 @@ static int zmk_rgb_underglow_init(const struct device *_arg) {
         return -EINVAL;
     }
 
+    brt_lut_init();
+
 #if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_EXT_POWER)
     ext_power = device_get_binding("EXT_POWER");
     if (ext_power == NULL) {
@@ -271,12 +703,19 @@ static int zmk_rgb_underglow_init(const struct device *_arg) {
     settings_load_subtree("rgb/underglow");
 #endif
 
+    // The reactive effects only exist with a zmk,underglow-layout node, so a start effect or saved
+    // effect may be out of range.
+    if (state.current_effect >= UNDERGLOW_EFFECT_NUMBER) {
+        LOG_WRN("Underglow effect %d is not available, using solid color", state.current_effect);
+        state.current_effect = UNDERGLOW_EFFECT_SOLID;
+    }
+
 #if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_AUTO_OFF_USB)
     state.on = zmk_usb_is_powered();
 #endif
 
     if (state.on) {
-        k_timer_start(&underglow_tick, K_NO_WAIT, K_MSEC(50));
+        zmk_rgb_underglow_start_frames();
     }
 
     return 0;
@@ -314,7 +753,7 @@ int zmk_rgb_underglow_on() {
 
     state.on = true;
     state.animation_step = 0;
-    k_timer_start(&underglow_tick, K_NO_WAIT, K_MSEC(50));
+    zmk_rgb_underglow_start_frames();
 
     return zmk_rgb_underglow_save_state();
 }
@@ -337,6 +776,7 @@ int zmk_rgb_underglow_off() {
     }
 
     led_strip_update_rgb(led_strip, pixels, STRIP_NUM_PIXELS);
+    last_pixels_valid = false;
 
     k_timer_stop(&underglow_tick);
     state.on = false;
@@ -359,6 +799,10 @@ int zmk_rgb_underglow_select_effect(int effect) {
     state.current_effect = effect;
     state.animation_step = 0;
 
+    if (state.on) {
+        zmk_rgb_underglow_start_frames();
+    }
+
     return zmk_rgb_underglow_save_state();
 }
 
@@ -376,6 +820,7 @@ int zmk_rgb_underglow_set_hsb(struct zmk_led_hsb color) {
     }
 
     state.color = color;
+    zmk_rgb_underglow_redraw();
 
     return 0;
 }
@@ -417,6 +862,7 @@ int zmk_rgb_underglow_change_hue(int direction) {
         return -ENODEV;
 
     state.color = zmk_rgb_underglow_calc_hue(direction);
+    zmk_rgb_underglow_redraw();
 
     return zmk_rgb_underglow_save_state();
 }
@@ -426,6 +872,7 @@ int zmk_rgb_underglow_change_sat(int direction) {
         return -ENODEV;
 
     state.color = zmk_rgb_underglow_calc_sat(direction);
+    zmk_rgb_underglow_redraw();
 
     return zmk_rgb_underglow_save_state();
 }
@@ -435,6 +882,7 @@ int zmk_rgb_underglow_change_brt(int direction) {
         return -ENODEV;
 
     state.color = zmk_rgb_underglow_calc_brt(direction);
+    zmk_rgb_underglow_redraw();
 
     return zmk_rgb_underglow_save_state();
 }
@@ -472,7 +920,11 @@ static int rgb_underglow_auto_state(bool *prev_state, bool new_state) {
         return zmk_rgb_underglow_off();
     }
 }
+#endif // IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_AUTO_OFF_IDLE) ||
+       // IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_AUTO_OFF_USB)
 
+#if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_AUTO_OFF_IDLE) ||                                          \
+    IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_AUTO_OFF_USB) || UNDERGLOW_HAS_LAYOUT
 static int rgb_underglow_event_listener(const zmk_event_t *eh) {
 
 #if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_AUTO_OFF_IDLE)
@@ -490,12 +942,31 @@ static int rgb_underglow_event_listener(const zmk_event_t *eh) {
     }
 #endif
 
+#if UNDERGLOW_HAS_LAYOUT
+    const struct zmk_position_state_changed *pos_ev = as_zmk_position_state_changed(eh);
+    if (pos_ev) {
+        // Only record the press here. The effects pick it up when they draw their next frame.
+        if (state.on && pos_ev->state) {
+            zmk_rgb_underglow_record_press(pos_ev->position, pos_ev->timestamp);
+        }
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+#endif
+
+#if UNDERGLOW_HAS_LAYOUT && UNDERGLOW_HAS_KEYMAP
+    if (as_zmk_layer_state_changed(eh)) {
+        if (state.current_effect == UNDERGLOW_EFFECT_LAYERS) {
+            zmk_rgb_underglow_redraw();
+        }
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+#endif
+
     return -ENOTSUP;
 }
 
 ZMK_LISTENER(rgb_underglow, rgb_underglow_event_listener);
-#endif // IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_AUTO_OFF_IDLE) ||
-       // IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_AUTO_OFF_USB)
+#endif
 
 #if IS_ENABLED(CONFIG_ZMK_RGB_UNDERGLOW_AUTO_OFF_IDLE)
 ZMK_SUBSCRIPTION(rgb_underglow, zmk_activity_state_changed);
@@ -505,4 +976,12 @@ ZMK_SUBSCRIPTION(rgb_underglow, zmk_activity_state_changed);
 ZMK_SUBSCRIPTION(rgb_underglow, zmk_usb_conn_state_changed);
 #endif
 
+#if UNDERGLOW_HAS_LAYOUT
+ZMK_SUBSCRIPTION(rgb_underglow, zmk_position_state_changed);
+#endif
+
+#if UNDERGLOW_HAS_LAYOUT && UNDERGLOW_HAS_KEYMAP
+ZMK_SUBSCRIPTION(rgb_underglow, zmk_layer_state_changed);
+#endif
+
 SYS_INIT(zmk_rgb_underglow_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <devicetree.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/crc.h>
+#include <sys/util.h>
+
+#include <zmk/split/behavior_ids.h>
+
+#define BEHAVIOR_LABEL(node_id)                                                                    \
+    COND_CODE_1(DT_NODE_HAS_PROP(node_id, label), (DT_LABEL(node_id), ), ())
+
+static const char *const behavior_labels[] = {
+#if DT_NODE_EXISTS(DT_PATH(behaviors))
+    DT_FOREACH_CHILD(DT_PATH(behaviors), BEHAVIOR_LABEL)
+#endif
+};
+
+BUILD_ASSERT(ARRAY_SIZE(behavior_labels) <= UINT8_MAX, "Too many behaviors to number in a byte");
+
+int zmk_split_behavior_id_for_label(const char *label) {
+    // Keymap bindings usually point at the same string literals as this table, so try the cheap
+    // pointer comparison before falling back to comparing the strings.
+    for (int i = 0; i < ARRAY_SIZE(behavior_labels); i++) {
+        if (behavior_labels[i] == label) {
+            return i;
+        }
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(behavior_labels); i++) {
+        if (strcmp(behavior_labels[i], label) == 0) {
+            return i;
+        }
+    }
+
+    return -ENODEV;
+}
+
+const char *zmk_split_behavior_label_for_id(uint8_t id) {
+    if (id >= ARRAY_SIZE(behavior_labels)) {
+        return NULL;
+    }
+
+    return behavior_labels[id];
+}
+
+uint8_t zmk_split_behavior_label_check(const char *label) {
+    return crc8_ccitt(0, label, strlen(label));
+}
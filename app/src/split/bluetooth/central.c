@@ -21,14 +21,19 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/ble.h>
 #include <zmk/behavior.h>
 #include <zmk/split/bluetooth/uuid.h>
+#include <zmk/split/bluetooth/central.h>
 #include <zmk/split/bluetooth/service.h>
+#include <zmk/split/behavior_ids.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
+#include <zmk/events/sensor_event.h>
 #include <init.h>
 
 static int start_scan(void);
 
-#define POSITION_STATE_DATA_LEN 16
+#define POSITION_STATE_DATA_LEN ZMK_SPLIT_POS_STATE_LEN
+
+#define PERIPHERAL_CONN_PARAM BT_LE_CONN_PARAM(0x0006, 0x0006, 30, 400)
 
 enum peripheral_slot_state {
     PERIPHERAL_SLOT_STATE_OPEN,
@@ -36,34 +41,179 @@ enum peripheral_slot_state {
     PERIPHERAL_SLOT_STATE_CONNECTED,
 };
 
+/*
+ * Estimates the offset between the peripheral's clock and ours as the minimum observed
+ * (arrival - capture) difference over the last two windows. That minimum includes the fastest
+ * transit seen, so events which arrive later than that are moved back by their extra delay.
+ * Arithmetic is done modulo 2^32 to match the width of the timestamps on the wire.
+ */
+struct peripheral_clock_offset {
+    bool valid;
+    uint32_t window_min;
+    uint32_t previous_window_min;
+    int64_t window_start;
+};
+
+/*
+ * Attribute handles of the split service on a peripheral, kept across disconnects so reconnecting
+ * to the same peripheral can subscribe straight away instead of running GATT discovery again.
+ */
+struct peripheral_handle_cache {
+    bool valid;
+    bt_addr_le_t addr;
+    uint16_t position_state_handle;
+    uint16_t position_state_ccc_handle;
+    uint16_t sensor_state_handle;
+    uint16_t sensor_state_ccc_handle;
+    uint16_t run_behavior_handle;
+    uint16_t run_behavior_id_handle;
+};
+
+struct reconnect_stats {
+    uint32_t count;
+    uint32_t direct_count;
+    uint32_t cached_handles_count;
+    uint32_t last_ms;
+    uint32_t max_ms;
+    uint64_t total_ms;
+};
+
 struct peripheral_slot {
     enum peripheral_slot_state state;
     struct bt_conn *conn;
+    bool direct_connect;
+    bool cached_handles;
     struct bt_gatt_discover_params discover_params;
     struct bt_gatt_subscribe_params subscribe_params;
     struct bt_gatt_discover_params sub_discover_params;
+    struct bt_gatt_subscribe_params sensor_subscribe_params;
+    struct bt_gatt_discover_params sensor_sub_discover_params;
     uint16_t run_behavior_handle;
+    uint16_t run_behavior_id_handle;
+    // Position state as last queued to be raised, which lags the peripheral's after a drop.
     uint8_t position_state[POSITION_STATE_DATA_LEN];
-    uint8_t changed_positions[POSITION_STATE_DATA_LEN];
+    atomic_t resync_needed;
+    atomic_t resync_in_progress;
+    struct bt_gatt_read_params read_params;
+    struct peripheral_clock_offset clock;
 };
 
 static struct peripheral_slot peripherals[ZMK_BLE_SPLIT_PERIPHERAL_COUNT];
 
+static struct peripheral_handle_cache handle_caches[ZMK_BLE_SPLIT_PERIPHERAL_COUNT];
+
+static struct reconnect_stats reconnect_stats;
+// Uptime at which the last peripheral connection was lost, or the central started.
+static int64_t peripheral_lost_at;
+
 static const struct bt_uuid_128 split_service_uuid = BT_UUID_INIT_128(ZMK_SPLIT_BT_SERVICE_UUID);
 
-K_MSGQ_DEFINE(peripheral_event_msgq, sizeof(struct zmk_position_state_changed),
+// All of the position changes from one notification, raised together.
+struct peripheral_event_batch {
+    uint8_t source;
+    int64_t timestamp;
+    uint8_t changed_positions[POSITION_STATE_DATA_LEN];
+    uint8_t position_state[POSITION_STATE_DATA_LEN];
+};
+
+static struct zmk_split_queue_stats position_queue_stats;
+
+static const uint8_t released_position_state[POSITION_STATE_DATA_LEN] = {0};
+
+static void resync_position_state(int index);
+
+K_MSGQ_DEFINE(peripheral_event_msgq, sizeof(struct peripheral_event_batch),
               CONFIG_ZMK_SPLIT_BLE_CENTRAL_POSITION_QUEUE_SIZE, 4);
 
 void peripheral_event_work_callback(struct k_work *work) {
-    struct zmk_position_state_changed ev;
-    while (k_msgq_get(&peripheral_event_msgq, &ev, K_NO_WAIT) == 0) {
-        LOG_DBG("Trigger key position state change for %d", ev.position);
-        ZMK_EVENT_RAISE(new_zmk_position_state_changed(ev));
+    struct peripheral_event_batch batch;
+    while (k_msgq_get(&peripheral_event_msgq, &batch, K_NO_WAIT) == 0) {
+        for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
+            for (int j = 0; j < 8; j++) {
+                if (!(batch.changed_positions[i] & BIT(j))) {
+                    continue;
+                }
+
+                uint32_t position = (i * 8) + j;
+                LOG_DBG("Trigger key position state change for %d", position);
+                ZMK_EVENT_RAISE(new_zmk_position_state_changed((struct zmk_position_state_changed){
+                    .source = batch.source,
+                    .position = position,
+                    .state = (batch.position_state[i] & BIT(j)) != 0,
+                    .timestamp = batch.timestamp}));
+            }
+        }
+    }
+
+    // With the queue drained there is room for whatever changes were dropped.
+    for (int i = 0; i < ZMK_BLE_SPLIT_PERIPHERAL_COUNT; i++) {
+        if (atomic_cas(&peripherals[i].resync_needed, 1, 0)) {
+            resync_position_state(i);
+        }
     }
 }
 
 K_WORK_DEFINE(peripheral_event_work, peripheral_event_work_callback);
 
+void zmk_split_get_queue_stats(struct zmk_split_queue_stats *stats) {
+    *stats = position_queue_stats;
+}
+
+/*
+ * Queues the changes between `position_state` and what was last queued for the peripheral. If the
+ * queue is full the changes are dropped without updating the slot's state, so they are picked up
+ * by the next notification or the resync requested once the queue has drained.
+ */
+static int queue_position_state(int index, const uint8_t *position_state, int64_t timestamp,
+                                k_timeout_t timeout) {
+    struct peripheral_slot *slot = &peripherals[index];
+    struct peripheral_event_batch batch = {.source = index, .timestamp = timestamp};
+    bool changed = false;
+
+    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
+        batch.changed_positions[i] = position_state[i] ^ slot->position_state[i];
+        batch.position_state[i] = position_state[i];
+        changed |= batch.changed_positions[i] != 0;
+    }
+
+    if (!changed) {
+        return 0;
+    }
+
+    int err = k_msgq_put(&peripheral_event_msgq, &batch, timeout);
+    if (err) {
+        position_queue_stats.dropped++;
+        atomic_set(&slot->resync_needed, 1);
+        LOG_WRN("Position event queue full, resyncing peripheral %d (%u dropped, high water %u)",
+                index, position_queue_stats.dropped, position_queue_stats.high_water);
+    } else {
+        memcpy(slot->position_state, position_state, POSITION_STATE_DATA_LEN);
+
+        uint32_t used = k_msgq_num_used_get(&peripheral_event_msgq);
+        if (used > position_queue_stats.high_water) {
+            position_queue_stats.high_water = used;
+            LOG_DBG("Position event queue high water mark now %u", used);
+        }
+    }
+
+    k_work_submit(&peripheral_event_work);
+
+    return err;
+}
+
+K_MSGQ_DEFINE(peripheral_sensor_event_msgq, sizeof(struct zmk_sensor_event),
+              CONFIG_ZMK_SPLIT_BLE_CENTRAL_SENSOR_QUEUE_SIZE, 4);
+
+void peripheral_sensor_event_work_callback(struct k_work *work) {
+    struct zmk_sensor_event ev;
+    while (k_msgq_get(&peripheral_sensor_event_msgq, &ev, K_NO_WAIT) == 0) {
+        LOG_DBG("Trigger sensor %d with delta %d", ev.sensor_number, ev.value.val1);
+        ZMK_EVENT_RAISE(new_zmk_sensor_event(ev));
+    }
+}
+
+K_WORK_DEFINE(peripheral_sensor_event_work, peripheral_sensor_event_work_callback);
+
 int peripheral_slot_index_for_conn(struct bt_conn *conn) {
     for (int i = 0; i < ZMK_BLE_SPLIT_PERIPHERAL_COUNT; i++) {
         if (peripherals[i].conn == conn) {
@@ -102,30 +252,29 @@ int release_peripheral_slot(int index) {
     }
     slot->state = PERIPHERAL_SLOT_STATE_OPEN;
 
-    // Raise events releasing any active positions from this peripheral
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        for (int j = 0; j < 8; j++) {
-            if (slot->position_state[i] & BIT(j)) {
-                uint32_t position = (i * 8) + j;
-                struct zmk_position_state_changed ev = {.source = index,
-                                                        .position = position,
-                                                        .state = false,
-                                                        .timestamp = k_uptime_get()};
+    atomic_clear(&slot->resync_needed);
+    atomic_clear(&slot->resync_in_progress);
 
-                k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
-                k_work_submit(&peripheral_event_work);
-            }
-        }
+    // Raise events releasing any active positions from this peripheral. This runs in the BT
+    // disconnect callback, so don't wait for room in the queue. If it is full, the slot keeps the
+    // held positions and the resync once the queue drains releases them instead.
+    if (queue_position_state(index, released_position_state, k_uptime_get(), K_NO_WAIT)) {
+        LOG_WRN("Releasing positions of peripheral %d once the queue drains", index);
     }
 
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        slot->position_state[i] = 0U;
-        slot->changed_positions[i] = 0U;
-    }
+    // The peripheral may have rebooted, so its clock can't be trusted to match.
+    slot->clock.valid = false;
 
     // Clean up previously discovered handles;
     slot->subscribe_params.value_handle = 0;
+    slot->subscribe_params.ccc_handle = 0;
+    slot->sensor_subscribe_params.value_handle = 0;
+    slot->sensor_subscribe_params.ccc_handle = 0;
     slot->run_behavior_handle = 0;
+    slot->run_behavior_id_handle = 0;
+
+    slot->direct_connect = false;
+    slot->cached_handles = false;
 
     return 0;
 }
@@ -162,6 +311,96 @@ int confirm_peripheral_slot_conn(struct bt_conn *conn) {
     return 0;
 }
 
+static struct peripheral_handle_cache *handle_cache_for_addr(const bt_addr_le_t *addr) {
+    for (int i = 0; i < ZMK_BLE_SPLIT_PERIPHERAL_COUNT; i++) {
+        if (handle_caches[i].valid && !bt_addr_le_cmp(&handle_caches[i].addr, addr)) {
+            return &handle_caches[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void store_handle_cache(struct peripheral_slot *slot) {
+    if (!slot->subscribe_params.value_handle || !slot->subscribe_params.ccc_handle ||
+        !slot->run_behavior_handle) {
+        return;
+    }
+
+    const bt_addr_le_t *addr = bt_conn_get_dst(slot->conn);
+    struct peripheral_handle_cache *cache = handle_cache_for_addr(addr);
+    if (cache == NULL) {
+        cache = &handle_caches[slot - peripherals];
+    }
+
+    *cache = (struct peripheral_handle_cache){
+        .valid = true,
+        .position_state_handle = slot->subscribe_params.value_handle,
+        .position_state_ccc_handle = slot->subscribe_params.ccc_handle,
+        .sensor_state_handle = slot->sensor_subscribe_params.value_handle,
+        .sensor_state_ccc_handle = slot->sensor_subscribe_params.ccc_handle,
+        .run_behavior_handle = slot->run_behavior_handle,
+        .run_behavior_id_handle = slot->run_behavior_id_handle,
+    };
+    bt_addr_le_copy(&cache->addr, addr);
+}
+
+static void invalidate_handle_cache(struct peripheral_slot *slot) {
+    struct peripheral_handle_cache *cache = handle_cache_for_addr(bt_conn_get_dst(slot->conn));
+    if (cache != NULL) {
+        cache->valid = false;
+    }
+}
+
+static void report_peripheral_ready(struct peripheral_slot *slot) {
+    uint32_t elapsed = k_uptime_get() - peripheral_lost_at;
+
+    reconnect_stats.count++;
+    reconnect_stats.direct_count += slot->direct_connect ? 1 : 0;
+    reconnect_stats.cached_handles_count += slot->cached_handles ? 1 : 0;
+    reconnect_stats.last_ms = elapsed;
+    reconnect_stats.max_ms = MAX(reconnect_stats.max_ms, elapsed);
+    reconnect_stats.total_ms += elapsed;
+
+    LOG_INF("Peripheral ready %u ms after it was lost (%s connection, %s handles)", elapsed,
+            slot->direct_connect ? "direct" : "scanned",
+            slot->cached_handles ? "cached" : "discovered");
+    LOG_INF("Peripheral reconnects: %u, %u direct, %u cached, avg %u ms, max %u ms",
+            reconnect_stats.count, reconnect_stats.direct_count,
+            reconnect_stats.cached_handles_count,
+            (uint32_t)(reconnect_stats.total_ms / reconnect_stats.count), reconnect_stats.max_ms);
+}
+
+static int64_t peripheral_timestamp_to_local(struct peripheral_clock_offset *clock,
+                                             uint32_t peripheral_timestamp, int64_t now) {
+    uint32_t sample = (uint32_t)now - peripheral_timestamp;
+
+    if (!clock->valid) {
+        clock->valid = true;
+        clock->window_min = sample;
+        clock->previous_window_min = sample;
+        clock->window_start = now;
+    } else if (now - clock->window_start >= CONFIG_ZMK_SPLIT_BLE_CENTRAL_CLOCK_OFFSET_WINDOW_MS) {
+        // Forget minimums older than two windows so the estimate follows clock drift.
+        clock->previous_window_min = clock->window_min;
+        clock->window_min = sample;
+        clock->window_start = now;
+    } else if ((int32_t)(sample - clock->window_min) < 0) {
+        clock->window_min = sample;
+    }
+
+    uint32_t offset = ((int32_t)(clock->window_min - clock->previous_window_min) < 0)
+                          ? clock->window_min
+                          : clock->previous_window_min;
+
+    int32_t delay = (int32_t)(sample - offset);
+    delay = CLAMP(delay, 0, CONFIG_ZMK_SPLIT_BLE_CENTRAL_CLOCK_MAX_CORRECTION_MS);
+
+    LOG_DBG("Peripheral timestamp %u arrived %d ms late", peripheral_timestamp, delay);
+
+    return now - delay;
+}
+
 static uint8_t split_central_notify_func(struct bt_conn *conn,
                                          struct bt_gatt_subscribe_params *params, const void *data,
                                          uint16_t length) {
@@ -180,40 +419,165 @@ static uint8_t split_central_notify_func(struct bt_conn *conn,
 
     LOG_DBG("[NOTIFICATION] data %p length %u", data, length);
 
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        slot->changed_positions[i] = ((uint8_t *)data)[i] ^ slot->position_state[i];
-        slot->position_state[i] = ((uint8_t *)data)[i];
-        LOG_DBG("data: %d", slot->position_state[i]);
+    if (length < POSITION_STATE_DATA_LEN) {
+        LOG_ERR("Position state notification too short (%u)", length);
+        return BT_GATT_ITER_CONTINUE;
     }
 
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        for (int j = 0; j < 8; j++) {
-            if (slot->changed_positions[i] & BIT(j)) {
-                uint32_t position = (i * 8) + j;
-                bool pressed = slot->position_state[i] & BIT(j);
-                struct zmk_position_state_changed ev = {.source =
-                                                            peripheral_slot_index_for_conn(conn),
-                                                        .position = position,
-                                                        .state = pressed,
-                                                        .timestamp = k_uptime_get()};
-
-                k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
-                k_work_submit(&peripheral_event_work);
-            }
-        }
+    int64_t timestamp = k_uptime_get();
+    if (length >= sizeof(struct zmk_split_position_state_payload)) {
+        const struct zmk_split_position_state_payload *payload = data;
+        timestamp = peripheral_timestamp_to_local(&slot->clock, payload->timestamp, timestamp);
     }
 
+    queue_position_state(peripheral_slot_index_for_conn(conn), data, timestamp, K_NO_WAIT);
+
     return BT_GATT_ITER_CONTINUE;
 }
 
-static void split_central_subscribe(struct bt_conn *conn) {
+static uint8_t split_central_read_position_state_func(struct bt_conn *conn, uint8_t err,
+                                                      struct bt_gatt_read_params *params,
+                                                      const void *data, uint16_t length) {
+    int index = peripheral_slot_index_for_conn(conn);
+    if (index < 0) {
+        return BT_GATT_ITER_STOP;
+    }
+
+    struct peripheral_slot *slot = &peripherals[index];
+    atomic_clear(&slot->resync_in_progress);
+
+    if (err) {
+        LOG_ERR("Failed to read peripheral position state (err %d)", err);
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (data == NULL) {
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (length < POSITION_STATE_DATA_LEN) {
+        LOG_ERR("Position state read too short (%u)", length);
+        return BT_GATT_ITER_STOP;
+    }
+
+    queue_position_state(index, data, k_uptime_get(), K_NO_WAIT);
+
+    return BT_GATT_ITER_STOP;
+}
+
+// Reads the peripheral's full position state to recover changes dropped from a full queue.
+static void resync_position_state(int index) {
+    struct peripheral_slot *slot = &peripherals[index];
+
+    if (slot->state != PERIPHERAL_SLOT_STATE_CONNECTED) {
+        // The peripheral disconnected before its positions could be released, so there is no
+        // state to read and everything it held is released.
+        queue_position_state(index, released_position_state, k_uptime_get(), K_NO_WAIT);
+        return;
+    }
+
+    if (!slot->subscribe_params.value_handle) {
+        return;
+    }
+
+    if (!atomic_cas(&slot->resync_in_progress, 0, 1)) {
+        // A read is already on its way, and will compare against the latest queued state.
+        return;
+    }
+
+    position_queue_stats.resyncs++;
+    LOG_DBG("Resyncing position state of peripheral %d (%u resyncs)", index,
+            position_queue_stats.resyncs);
+
+    slot->read_params.func = split_central_read_position_state_func;
+    slot->read_params.handle_count = 1;
+    slot->read_params.single.handle = slot->subscribe_params.value_handle;
+    slot->read_params.single.offset = 0;
+
+    int err = bt_gatt_read(slot->conn, &slot->read_params);
+    if (err) {
+        LOG_ERR("Failed to request peripheral position state (err %d)", err);
+        atomic_clear(&slot->resync_in_progress);
+    }
+}
+
+static uint8_t split_central_sensor_notify_func(struct bt_conn *conn,
+                                                struct bt_gatt_subscribe_params *params,
+                                                const void *data, uint16_t length) {
     struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+
     if (slot == NULL) {
         LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    if (!data) {
+        LOG_DBG("[UNSUBSCRIBED]");
+        params->value_handle = 0U;
+        return BT_GATT_ITER_STOP;
+    }
+
+    const size_t header_len = offsetof(struct zmk_split_sensor_state_payload, deltas);
+    if (length < header_len || (length - header_len) % sizeof(struct zmk_split_sensor_delta) ||
+        length > sizeof(struct zmk_split_sensor_state_payload)) {
+        LOG_ERR("Invalid sensor state notification length (%u)", length);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    struct zmk_split_sensor_state_payload payload;
+    memcpy(&payload, data, length);
+
+    int64_t timestamp = peripheral_timestamp_to_local(&slot->clock, payload.timestamp,
+                                                      k_uptime_get());
+    size_t count = (length - header_len) / sizeof(struct zmk_split_sensor_delta);
+
+    for (int i = 0; i < count; i++) {
+        struct zmk_sensor_event ev = {
+            .sensor_number = payload.deltas[i].sensor_number,
+            .sensor = NULL,
+            .value = {.val1 = payload.deltas[i].delta},
+            .timestamp = timestamp,
+        };
+
+        k_msgq_put(&peripheral_sensor_event_msgq, &ev, K_NO_WAIT);
+        k_work_submit(&peripheral_sensor_event_work);
+    }
+
+    return BT_GATT_ITER_CONTINUE;
+}
+
+static void split_central_subscribe_func(struct bt_conn *conn, uint8_t err,
+                                         struct bt_gatt_subscribe_params *params) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+    if (slot == NULL) {
         return;
     }
 
-    int err = bt_gatt_subscribe(conn, &slot->subscribe_params);
+    if (err) {
+        LOG_ERR("Failed to enable notifications (err %d)", err);
+
+        bool security_err = (err == BT_ATT_ERR_AUTHENTICATION ||
+                             err == BT_ATT_ERR_INSUFFICIENT_ENCRYPTION ||
+                             err == BT_ATT_ERR_ENCRYPTION_KEY_SIZE);
+        if (slot->cached_handles && !security_err) {
+            // The peripheral's attribute table changed, likely from a firmware update. Reconnect
+            // without the cached handles to discover it again.
+            LOG_WRN("Cached peripheral handles are stale, rediscovering");
+            invalidate_handle_cache(slot);
+            bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+        }
+        return;
+    }
+
+    store_handle_cache(slot);
+
+    if (params == &slot->subscribe_params) {
+        report_peripheral_ready(slot);
+    }
+}
+
+static void split_central_subscribe(struct bt_conn *conn, struct bt_gatt_subscribe_params *params) {
+    int err = bt_gatt_subscribe(conn, params);
     switch (err) {
     case -EALREADY:
         LOG_DBG("[ALREADY SUBSCRIBED]");
@@ -232,6 +596,11 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
                                                  struct bt_gatt_discover_params *params) {
     if (!attr) {
         LOG_DBG("Discover complete");
+
+        struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+        if (slot != NULL) {
+            store_handle_cache(slot);
+        }
         return BT_GATT_ITER_STOP;
     }
 
@@ -259,17 +628,44 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
         slot->subscribe_params.end_handle = slot->discover_params.end_handle;
         slot->subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
         slot->subscribe_params.notify = split_central_notify_func;
+        slot->subscribe_params.subscribe = split_central_subscribe_func;
         slot->subscribe_params.value = BT_GATT_CCC_NOTIFY;
-        split_central_subscribe(conn);
+        split_central_subscribe(conn, &slot->subscribe_params);
+    } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
+                            BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_SENSOR_STATE_UUID))) {
+        LOG_DBG("Found sensor state characteristic");
+        slot->discover_params.uuid = NULL;
+        slot->discover_params.start_handle = attr->handle + 2;
+        slot->discover_params.type = BT_GATT_DISCOVER_CHARACTERISTIC;
+
+        slot->sensor_subscribe_params.disc_params = &slot->sensor_sub_discover_params;
+        slot->sensor_subscribe_params.end_handle = slot->discover_params.end_handle;
+        slot->sensor_subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
+        slot->sensor_subscribe_params.notify = split_central_sensor_notify_func;
+        slot->sensor_subscribe_params.subscribe = split_central_subscribe_func;
+        slot->sensor_subscribe_params.value = BT_GATT_CCC_NOTIFY;
+        split_central_subscribe(conn, &slot->sensor_subscribe_params);
     } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
                             BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIOR_UUID))) {
         LOG_DBG("Found run behavior handle");
         slot->run_behavior_handle = bt_gatt_attr_value_handle(attr);
+    } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
+                            BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIOR_ID_UUID))) {
+        LOG_DBG("Found run behavior id handle");
+        slot->run_behavior_id_handle = bt_gatt_attr_value_handle(attr);
     }
 
-    bool subscribed = (slot->run_behavior_handle && slot->subscribe_params.value_handle);
+    // Peripherals running older firmware don't have the run behavior id or sensor state
+    // characteristics, in which case discovery continues until the end of the service.
+    bool subscribed = (slot->run_behavior_handle && slot->run_behavior_id_handle &&
+                       slot->subscribe_params.value_handle &&
+                       slot->sensor_subscribe_params.value_handle);
+    if (subscribed) {
+        store_handle_cache(slot);
+        return BT_GATT_ITER_STOP;
+    }
 
-    return subscribed ? BT_GATT_ITER_STOP : BT_GATT_ITER_CONTINUE;
+    return BT_GATT_ITER_CONTINUE;
 }
 
 static uint8_t split_central_service_discovery_func(struct bt_conn *conn,
@@ -307,6 +703,41 @@ static uint8_t split_central_service_discovery_func(struct bt_conn *conn,
     return BT_GATT_ITER_STOP;
 }
 
+static bool restore_handle_cache(struct bt_conn *conn, struct peripheral_slot *slot) {
+    const struct peripheral_handle_cache *cache = handle_cache_for_addr(bt_conn_get_dst(conn));
+    if (cache == NULL) {
+        return false;
+    }
+
+    LOG_DBG("Using cached split service handles");
+    slot->cached_handles = true;
+    slot->run_behavior_handle = cache->run_behavior_handle;
+    slot->run_behavior_id_handle = cache->run_behavior_id_handle;
+
+    // A zero CCC handle is still discovered automatically before subscribing.
+    slot->subscribe_params.disc_params = &slot->sub_discover_params;
+    slot->subscribe_params.end_handle = 0xffff;
+    slot->subscribe_params.value_handle = cache->position_state_handle;
+    slot->subscribe_params.ccc_handle = cache->position_state_ccc_handle;
+    slot->subscribe_params.notify = split_central_notify_func;
+    slot->subscribe_params.subscribe = split_central_subscribe_func;
+    slot->subscribe_params.value = BT_GATT_CCC_NOTIFY;
+    split_central_subscribe(conn, &slot->subscribe_params);
+
+    if (cache->sensor_state_handle) {
+        slot->sensor_subscribe_params.disc_params = &slot->sensor_sub_discover_params;
+        slot->sensor_subscribe_params.end_handle = 0xffff;
+        slot->sensor_subscribe_params.value_handle = cache->sensor_state_handle;
+        slot->sensor_subscribe_params.ccc_handle = cache->sensor_state_ccc_handle;
+        slot->sensor_subscribe_params.notify = split_central_sensor_notify_func;
+        slot->sensor_subscribe_params.subscribe = split_central_subscribe_func;
+        slot->sensor_subscribe_params.value = BT_GATT_CCC_NOTIFY;
+        split_central_subscribe(conn, &slot->sensor_subscribe_params);
+    }
+
+    return true;
+}
+
 static void split_central_process_connection(struct bt_conn *conn) {
     int err;
 
@@ -324,7 +755,7 @@ static void split_central_process_connection(struct bt_conn *conn) {
         return;
     }
 
-    if (!slot->subscribe_params.value_handle) {
+    if (!slot->subscribe_params.value_handle && !restore_handle_cache(conn, slot)) {
         slot->discover_params.uuid = &split_service_uuid.uuid;
         slot->discover_params.func = split_central_service_discovery_func;
         slot->discover_params.start_handle = 0x0001;
@@ -409,7 +840,7 @@ static bool split_central_eir_found(struct bt_data *data, void *user_data) {
                     LOG_ERR("Update phy conn failed (err %d)", err);
                 }
             } else {
-                param = BT_LE_CONN_PARAM(0x0006, 0x0006, 30, 400);
+                param = PERIPHERAL_CONN_PARAM;
 
                 LOG_DBG("Initiating new connnection");
 
@@ -455,6 +886,70 @@ static int start_scan(void) {
     return 0;
 }
 
+struct bonded_addr_search {
+    const bt_addr_le_t *addr;
+    bool found;
+};
+
+static void bonded_addr_search_func(const struct bt_bond_info *info, void *user_data) {
+    struct bonded_addr_search *search = user_data;
+
+    if (!bt_addr_le_cmp(&info->addr, search->addr)) {
+        search->found = true;
+    }
+}
+
+static const struct bt_conn_le_create_param direct_create_param = {
+    .options = BT_CONN_LE_OPT_NONE,
+    .interval = BT_GAP_SCAN_FAST_INTERVAL,
+    .window = BT_GAP_SCAN_FAST_INTERVAL,
+    .timeout = CONFIG_ZMK_SPLIT_BLE_CENTRAL_DIRECT_CONNECT_TIMEOUT_MS / 10,
+};
+
+// Connects straight to the bonded peripheral we last saw, skipping the wait for its advertising
+// to be matched by a scan.
+static int connect_to_bonded_peripheral(void) {
+    const bt_addr_le_t *addr = zmk_ble_get_peripheral_addr();
+    if (addr == NULL) {
+        return -ENOENT;
+    }
+
+    struct bonded_addr_search search = {.addr = addr};
+    bt_foreach_bond(BT_ID_DEFAULT, bonded_addr_search_func, &search);
+    if (!search.found) {
+        return -ENOENT;
+    }
+
+    int slot_idx = reserve_peripheral_slot();
+    if (slot_idx < 0) {
+        return slot_idx;
+    }
+
+    struct peripheral_slot *slot = &peripherals[slot_idx];
+
+    LOG_DBG("Initiating direct connection to bonded peripheral");
+
+    int err = bt_conn_le_create(addr, &direct_create_param, PERIPHERAL_CONN_PARAM, &slot->conn);
+    if (err) {
+        LOG_WRN("Direct connection to bonded peripheral failed (err %d)", err);
+        release_peripheral_slot(slot_idx);
+        return err;
+    }
+
+    slot->direct_connect = true;
+
+    return 0;
+}
+
+// Scanning is the fallback when there is no bonded peripheral, or connecting to it timed out.
+static int start_peripheral_connection(void) {
+    if (connect_to_bonded_peripheral() == 0) {
+        return 0;
+    }
+
+    return start_scan();
+}
+
 static void split_central_connected(struct bt_conn *conn, uint8_t conn_err) {
     char addr[BT_ADDR_LE_STR_LEN];
     struct bt_conn_info info;
@@ -497,7 +992,8 @@ static void split_central_disconnected(struct bt_conn *conn, uint8_t reason) {
         return;
     }
 
-    start_scan();
+    peripheral_lost_at = k_uptime_get();
+    start_peripheral_connection();
 }
 
 static struct bt_conn_cb conn_callbacks = {
@@ -512,6 +1008,8 @@ struct k_work_q split_central_split_run_q;
 
 struct zmk_split_run_behavior_payload_wrapper {
     uint8_t source;
+    int behavior_id;
+    uint8_t behavior_label_check;
     struct zmk_split_run_behavior_payload payload;
 };
 
@@ -525,15 +1023,29 @@ void split_central_split_run_callback(struct k_work *work) {
     LOG_DBG("");
 
     while (k_msgq_get(&zmk_split_central_split_run_msgq, &payload_wrapper, K_NO_WAIT) == 0) {
-        if (peripherals[payload_wrapper.source].state != PERIPHERAL_SLOT_STATE_CONNECTED) {
+        struct peripheral_slot *slot = &peripherals[payload_wrapper.source];
+
+        if (slot->state != PERIPHERAL_SLOT_STATE_CONNECTED) {
             LOG_ERR("Source not connected");
             continue;
         }
 
-        int err = bt_gatt_write_without_response(
-            peripherals[payload_wrapper.source].conn,
-            peripherals[payload_wrapper.source].run_behavior_handle, &payload_wrapper.payload,
-            sizeof(struct zmk_split_run_behavior_payload), true);
+        int err;
+        if (payload_wrapper.behavior_id >= 0 && slot->run_behavior_id_handle) {
+            struct zmk_split_run_behavior_id_payload id_payload = {
+                .data = payload_wrapper.payload.data,
+                .behavior_id = payload_wrapper.behavior_id,
+                .behavior_label_check = payload_wrapper.behavior_label_check,
+            };
+
+            err = bt_gatt_write_without_response(slot->conn, slot->run_behavior_id_handle,
+                                                 &id_payload, sizeof(id_payload), true);
+        } else {
+            err = bt_gatt_write_without_response(slot->conn, slot->run_behavior_handle,
+                                                 &payload_wrapper.payload,
+                                                 sizeof(struct zmk_split_run_behavior_payload),
+                                                 true);
+        }
 
         if (err) {
             LOG_ERR("Failed to write the behavior characteristic (err %d)", err);
@@ -567,8 +1079,8 @@ split_bt_invoke_behavior_payload(struct zmk_split_run_behavior_payload_wrapper p
     return 0;
 };
 
-int zmk_split_bt_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
-                                 struct zmk_behavior_binding_event event, bool state) {
+int zmk_split_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
+                              struct zmk_behavior_binding_event event, bool state) {
     struct zmk_split_run_behavior_payload payload = {.data = {
                                                          .param1 = binding->param1,
                                                          .param2 = binding->param2,
@@ -582,7 +1094,12 @@ int zmk_split_bt_invoke_behavior(uint8_t source, struct zmk_behavior_binding *bi
                 log_strdup(binding->behavior_dev), log_strdup(payload.behavior_dev));
     }
 
-    struct zmk_split_run_behavior_payload_wrapper wrapper = {.source = source, .payload = payload};
+    struct zmk_split_run_behavior_payload_wrapper wrapper = {
+        .source = source,
+        .behavior_id = zmk_split_behavior_id_for_label(binding->behavior_dev),
+        .behavior_label_check = zmk_split_behavior_label_check(binding->behavior_dev),
+        .payload = payload,
+    };
     return split_bt_invoke_behavior_payload(wrapper);
 }
 
@@ -592,7 +1109,8 @@ int zmk_split_bt_central_init(const struct device *_arg) {
                        CONFIG_ZMK_BLE_THREAD_PRIORITY, NULL);
     bt_conn_cb_register(&conn_callbacks);
 
-    return start_scan();
+    peripheral_lost_at = k_uptime_get();
+    return start_peripheral_connection();
 }
 
 SYS_INIT(zmk_split_bt_central_init, APPLICATION, CONFIG_ZMK_BLE_INIT_PRIORITY);
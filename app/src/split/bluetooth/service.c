@@ -18,10 +18,12 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <drivers/behavior.h>
 #include <zmk/behavior.h>
 #include <zmk/matrix.h>
+#include <zmk/sensors.h>
 #include <zmk/split/bluetooth/uuid.h>
 #include <zmk/split/bluetooth/service.h>
+#include <zmk/split/behavior_ids.h>
 
-#define POS_STATE_LEN 16
+#define POS_STATE_LEN ZMK_SPLIT_POS_STATE_LEN
 
 static uint8_t num_of_positions = ZMK_KEYMAP_LEN;
 static uint8_t position_state[POS_STATE_LEN];
@@ -34,6 +36,28 @@ static ssize_t split_svc_pos_state(struct bt_conn *conn, const struct bt_gatt_at
                              sizeof(position_state));
 }
 
+static void run_behavior(char *behavior_dev, const struct zmk_split_run_behavior_data *data) {
+    struct zmk_behavior_binding binding = {
+        .param1 = data->param1,
+        .param2 = data->param2,
+        .behavior_dev = behavior_dev,
+    };
+    LOG_DBG("%s with params %d %d: pressed? %d", log_strdup(binding.behavior_dev), binding.param1,
+            binding.param2, data->state);
+    struct zmk_behavior_binding_event event = {.position = data->position,
+                                               .timestamp = k_uptime_get()};
+    int err;
+    if (data->state > 0) {
+        err = behavior_keymap_binding_pressed(&binding, event);
+    } else {
+        err = behavior_keymap_binding_released(&binding, event);
+    }
+
+    if (err) {
+        LOG_ERR("Failed to invoke behavior %s: %d", log_strdup(binding.behavior_dev), err);
+    }
+}
+
 static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
                                       const void *buf, uint16_t len, uint16_t offset,
                                       uint8_t flags) {
@@ -46,7 +70,7 @@ static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt
         return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
     }
 
-    memcpy(payload + offset, buf, len);
+    memcpy((uint8_t *)payload + offset, buf, len);
 
     // We run if:
     // 1: We've gotten all the position/state/param data.
@@ -55,27 +79,32 @@ static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt
         offsetof(struct zmk_split_run_behavior_payload, behavior_dev);
     if ((end_addr > sizeof(struct zmk_split_run_behavior_data)) &&
         payload->behavior_dev[end_addr - behavior_dev_offset - 1] == '\0') {
-        struct zmk_behavior_binding binding = {
-            .param1 = payload->data.param1,
-            .param2 = payload->data.param2,
-            .behavior_dev = payload->behavior_dev,
-        };
-        LOG_DBG("%s with params %d %d: pressed? %d", log_strdup(binding.behavior_dev),
-                binding.param1, binding.param2, payload->data.state);
-        struct zmk_behavior_binding_event event = {.position = payload->data.position,
-                                                   .timestamp = k_uptime_get()};
-        int err;
-        if (payload->data.state > 0) {
-            err = behavior_keymap_binding_pressed(&binding, event);
-        } else {
-            err = behavior_keymap_binding_released(&binding, event);
-        }
+        run_behavior(payload->behavior_dev, &payload->data);
+    }
 
-        if (err) {
-            LOG_ERR("Failed to invoke behavior %s: %d", log_strdup(binding.behavior_dev), err);
-        }
+    return len;
+}
+
+static ssize_t split_svc_run_behavior_id(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
+                                         const void *buf, uint16_t len, uint16_t offset,
+                                         uint8_t flags) {
+    struct zmk_split_run_behavior_id_payload payload;
+
+    if (offset != 0 || len != sizeof(payload)) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    memcpy(&payload, buf, len);
+
+    const char *label = zmk_split_behavior_label_for_id(payload.behavior_id);
+    if (label == NULL || zmk_split_behavior_label_check(label) != payload.behavior_label_check) {
+        LOG_ERR("Unknown behavior id %d, are both halves built from the same keymap?",
+                payload.behavior_id);
+        return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
     }
 
+    run_behavior((char *)label, &payload.data);
+
     return len;
 }
 
@@ -88,6 +117,10 @@ static void split_svc_pos_state_ccc(const struct bt_gatt_attr *attr, uint16_t va
     LOG_DBG("value %d", value);
 }
 
+static void split_svc_sensor_state_ccc(const struct bt_gatt_attr *attr, uint16_t value) {
+    LOG_DBG("value %d", value);
+}
+
 BT_GATT_SERVICE_DEFINE(
     split_svc, BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_SERVICE_UUID)),
     BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_STATE_UUID),
@@ -98,20 +131,27 @@ BT_GATT_SERVICE_DEFINE(
                            BT_GATT_CHRC_WRITE_WITHOUT_RESP, BT_GATT_PERM_WRITE_ENCRYPT, NULL,
                            split_svc_run_behavior, &behavior_run_payload),
     BT_GATT_DESCRIPTOR(BT_UUID_NUM_OF_DIGITALS, BT_GATT_PERM_READ, split_svc_num_of_positions, NULL,
-                       &num_of_positions), );
+                       &num_of_positions),
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIOR_ID_UUID),
+                           BT_GATT_CHRC_WRITE_WITHOUT_RESP, BT_GATT_PERM_WRITE_ENCRYPT, NULL,
+                           split_svc_run_behavior_id, NULL),
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_SENSOR_STATE_UUID),
+                           BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_NONE, NULL, NULL, NULL),
+    BT_GATT_CCC(split_svc_sensor_state_ccc,
+                BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT), );
 
 K_THREAD_STACK_DEFINE(service_q_stack, CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_STACK_SIZE);
 
 struct k_work_q service_work_q;
 
-K_MSGQ_DEFINE(position_state_msgq, sizeof(char[POS_STATE_LEN]),
+K_MSGQ_DEFINE(position_state_msgq, sizeof(struct zmk_split_position_state_payload),
               CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE, 4);
 
 void send_position_state_callback(struct k_work *work) {
-    uint8_t state[POS_STATE_LEN];
+    struct zmk_split_position_state_payload payload;
 
-    while (k_msgq_get(&position_state_msgq, &state, K_NO_WAIT) == 0) {
-        int err = bt_gatt_notify(NULL, &split_svc.attrs[1], &state, sizeof(state));
+    while (k_msgq_get(&position_state_msgq, &payload, K_NO_WAIT) == 0) {
+        int err = bt_gatt_notify(NULL, &split_svc.attrs[1], &payload, sizeof(payload));
         if (err) {
             LOG_DBG("Error notifying %d", err);
         }
@@ -120,15 +160,15 @@ void send_position_state_callback(struct k_work *work) {
 
 K_WORK_DEFINE(service_position_notify_work, send_position_state_callback);
 
-int send_position_state() {
-    int err = k_msgq_put(&position_state_msgq, position_state, K_MSEC(100));
+static int queue_position_state(struct zmk_split_position_state_payload *payload) {
+    int err = k_msgq_put(&position_state_msgq, payload, K_MSEC(100));
     if (err) {
         switch (err) {
         case -EAGAIN: {
             LOG_WRN("Position state message queue full, popping first message and queueing again");
-            uint8_t discarded_state[POS_STATE_LEN];
-            k_msgq_get(&position_state_msgq, &discarded_state, K_NO_WAIT);
-            return send_position_state();
+            struct zmk_split_position_state_payload discarded_payload;
+            k_msgq_get(&position_state_msgq, &discarded_payload, K_NO_WAIT);
+            return queue_position_state(payload);
         }
         default:
             LOG_WRN("Failed to queue position state to send (%d)", err);
@@ -141,16 +181,106 @@ int send_position_state() {
     return 0;
 }
 
-int zmk_split_bt_position_pressed(uint8_t position) {
+int send_position_state(int64_t timestamp) {
+    struct zmk_split_position_state_payload payload = {.timestamp = (uint32_t)timestamp};
+    memcpy(payload.position_state, position_state, sizeof(position_state));
+
+    return queue_position_state(&payload);
+}
+
+int zmk_split_position_pressed(uint8_t position, int64_t timestamp) {
     WRITE_BIT(position_state[position / 8], position % 8, true);
-    return send_position_state();
+    return send_position_state(timestamp);
 }
 
-int zmk_split_bt_position_released(uint8_t position) {
+int zmk_split_position_released(uint8_t position, int64_t timestamp) {
     WRITE_BIT(position_state[position / 8], position % 8, false);
-    return send_position_state();
+    return send_position_state(timestamp);
 }
 
+#if ZMK_KEYMAP_HAS_SENSORS
+
+static struct k_spinlock sensor_lock;
+static int32_t sensor_deltas[ZMK_KEYMAP_SENSORS_LEN];
+static bool sensor_pending;
+static int64_t sensor_pending_since;
+
+// Moves up to a notification's worth of accumulated rotation into `payload`, returning the number
+// of entries used. Deltas too large for a single entry leave their remainder for the next call.
+static size_t take_sensor_deltas(struct zmk_split_sensor_state_payload *payload) {
+    size_t count = 0;
+    k_spinlock_key_t key = k_spin_lock(&sensor_lock);
+
+    payload->timestamp = (uint32_t)sensor_pending_since;
+    sensor_pending = false;
+
+    for (int i = 0; i < ZMK_KEYMAP_SENSORS_LEN; i++) {
+        if (sensor_deltas[i] == 0) {
+            continue;
+        }
+
+        if (count == ZMK_SPLIT_SENSOR_DELTAS_MAX) {
+            sensor_pending = true;
+            break;
+        }
+
+        int8_t delta = CLAMP(sensor_deltas[i], INT8_MIN, INT8_MAX);
+        sensor_deltas[i] -= delta;
+        sensor_pending |= sensor_deltas[i] != 0;
+
+        payload->deltas[count++] =
+            (struct zmk_split_sensor_delta){.sensor_number = i, .delta = delta};
+    }
+
+    k_spin_unlock(&sensor_lock, key);
+
+    return count;
+}
+
+void send_sensor_state_callback(struct k_work *work) {
+    const struct bt_gatt_attr *attr =
+        bt_gatt_find_by_uuid(split_svc.attrs, split_svc.attr_count,
+                             BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_SENSOR_STATE_UUID));
+    struct zmk_split_sensor_state_payload payload;
+    size_t count;
+
+    while ((count = take_sensor_deltas(&payload)) > 0) {
+        size_t len = offsetof(struct zmk_split_sensor_state_payload, deltas) +
+                     (count * sizeof(struct zmk_split_sensor_delta));
+
+        int err = bt_gatt_notify(NULL, attr, &payload, len);
+        if (err) {
+            LOG_DBG("Error notifying %d", err);
+        }
+    }
+}
+
+K_WORK_DEFINE(service_sensor_notify_work, send_sensor_state_callback);
+
+int zmk_split_sensor_triggered(uint8_t sensor_number, int32_t delta, int64_t timestamp) {
+    if (sensor_number >= ZMK_KEYMAP_SENSORS_LEN) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&sensor_lock);
+
+    if (!sensor_pending) {
+        sensor_pending = true;
+        sensor_pending_since = timestamp;
+    }
+    sensor_deltas[sensor_number] += delta;
+
+    k_spin_unlock(&sensor_lock, key);
+
+    // Ticks arriving while the previous notification is still being sent are picked up by the
+    // same work item, so a fast turn of the encoder only produces a few notifications.
+    k_work_submit_to_queue(&service_work_q, &service_sensor_notify_work);
+
+    return 0;
+}
+
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
 int service_init(const struct device *_arg) {
     static const struct k_work_queue_config queue_config = {
         .name = "Split Peripheral Notification Queue"};
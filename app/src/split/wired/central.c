@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <kernel.h>
+#include <string.h>
+#include <sys/util.h>
+
+#include <logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/behavior.h>
+#include <zmk/split/behavior_ids.h>
+#include <zmk/split/wired/wired.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/events/sensor_event.h>
+
+// Only a single peripheral can be attached to the UART.
+#define PERIPHERAL_SOURCE 0
+
+static uint8_t position_state[ZMK_SPLIT_POS_STATE_LEN];
+
+static void raise_position_state_changed(uint32_t position, bool pressed, int64_t timestamp) {
+    WRITE_BIT(position_state[position / 8], position % 8, pressed);
+
+    LOG_DBG("Trigger key position state change for %d", position);
+    ZMK_EVENT_RAISE(new_zmk_position_state_changed(
+        (struct zmk_position_state_changed){.source = PERIPHERAL_SOURCE,
+                                            .position = position,
+                                            .state = pressed,
+                                            .timestamp = timestamp}));
+}
+
+static void handle_position_event(const struct zmk_split_wired_position_event *ev, uint8_t len,
+                                  int64_t timestamp) {
+    if (len != sizeof(*ev) || ev->position >= ZMK_SPLIT_POS_STATE_LEN * 8) {
+        LOG_ERR("Invalid position event");
+        return;
+    }
+
+    bool pressed = ev->state > 0;
+    if ((bool)(position_state[ev->position / 8] & BIT(ev->position % 8)) == pressed) {
+        return;
+    }
+
+    // The frame was sent `age` milliseconds after the key changed, and then spent a fixed time on
+    // the wire before we received it.
+    uint32_t latency_us = (ev->age * USEC_PER_MSEC) + zmk_split_wired_frame_time_us(sizeof(*ev));
+    LOG_DBG("Position %d changed %d us before it was received", ev->position, latency_us);
+
+    raise_position_state_changed(ev->position, pressed, timestamp - latency_us / USEC_PER_MSEC);
+}
+
+static void handle_position_state(const struct zmk_split_wired_position_state *state, uint8_t len,
+                                  int64_t timestamp) {
+    if (len != sizeof(*state)) {
+        LOG_ERR("Invalid position state");
+        return;
+    }
+
+    for (int i = 0; i < ZMK_SPLIT_POS_STATE_LEN; i++) {
+        uint8_t changed = state->position_state[i] ^ position_state[i];
+        for (int j = 0; j < 8; j++) {
+            if (changed & BIT(j)) {
+                raise_position_state_changed((i * 8) + j, state->position_state[i] & BIT(j),
+                                             timestamp);
+            }
+        }
+    }
+}
+
+static void handle_sensor_event(const struct zmk_split_wired_sensor_event *ev, uint8_t len,
+                                int64_t timestamp) {
+    if (len != sizeof(*ev)) {
+        LOG_ERR("Invalid sensor event");
+        return;
+    }
+
+    uint32_t latency_us = (ev->age * USEC_PER_MSEC) + zmk_split_wired_frame_time_us(sizeof(*ev));
+
+    LOG_DBG("Trigger sensor %d with delta %d", ev->sensor_number, ev->delta);
+    ZMK_EVENT_RAISE(new_zmk_sensor_event(
+        (struct zmk_sensor_event){.sensor_number = ev->sensor_number,
+                                  .sensor = NULL,
+                                  .value = {.val1 = ev->delta},
+                                  .timestamp = timestamp - latency_us / USEC_PER_MSEC}));
+}
+
+void zmk_split_wired_message_received(enum zmk_split_wired_msg_type type, const uint8_t *payload,
+                                      uint8_t len, int64_t timestamp) {
+    switch (type) {
+    case ZMK_SPLIT_WIRED_MSG_POSITION_EVENT:
+        handle_position_event((const struct zmk_split_wired_position_event *)payload, len,
+                              timestamp);
+        break;
+    case ZMK_SPLIT_WIRED_MSG_POSITION_STATE:
+        handle_position_state((const struct zmk_split_wired_position_state *)payload, len,
+                              timestamp);
+        break;
+    case ZMK_SPLIT_WIRED_MSG_SENSOR_EVENT:
+        handle_sensor_event((const struct zmk_split_wired_sensor_event *)payload, len, timestamp);
+        break;
+    default:
+        LOG_WRN("Unexpected split message type 0x%02x", type);
+        break;
+    }
+}
+
+static void request_sync(void) { zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_SYNC_REQUEST, NULL, 0); }
+
+void zmk_split_wired_frame_dropped(void) {
+    // The dropped frame may have been a release, so ask for the full state to avoid stuck keys.
+    request_sync();
+}
+
+void zmk_split_wired_ready(void) { request_sync(); }
+
+int zmk_split_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
+                              struct zmk_behavior_binding_event event, bool state) {
+    struct zmk_split_wired_run_behavior_data data = {
+        .position = event.position,
+        .state = state ? 1 : 0,
+        .param1 = binding->param1,
+        .param2 = binding->param2,
+    };
+
+    int behavior_id = zmk_split_behavior_id_for_label(binding->behavior_dev);
+    if (behavior_id >= 0) {
+        struct zmk_split_wired_run_behavior_id payload = {
+            .data = data,
+            .behavior_id = behavior_id,
+            .behavior_label_check = zmk_split_behavior_label_check(binding->behavior_dev),
+        };
+
+        return zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_RUN_BEHAVIOR_ID, &payload,
+                                    sizeof(payload));
+    }
+
+    uint8_t buf[ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN];
+    struct zmk_split_wired_run_behavior *payload = (struct zmk_split_wired_run_behavior *)buf;
+    size_t label_len = strlen(binding->behavior_dev);
+
+    if (sizeof(*payload) + label_len > sizeof(buf)) {
+        LOG_ERR("Behavior label %s is too long to send to the peripheral",
+                log_strdup(binding->behavior_dev));
+        return -EINVAL;
+    }
+
+    payload->data = data;
+    memcpy(payload->behavior_dev, binding->behavior_dev, label_len);
+
+    return zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_RUN_BEHAVIOR, payload,
+                                sizeof(*payload) + label_len);
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <kernel.h>
+#include <string.h>
+#include <sys/util.h>
+
+#include <logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <drivers/behavior.h>
+#include <zmk/behavior.h>
+#include <zmk/sensors.h>
+#include <zmk/split/behavior_ids.h>
+#include <zmk/split/wired/wired.h>
+
+static uint8_t position_state[ZMK_SPLIT_POS_STATE_LEN];
+
+static int send_position_state(void) {
+    struct zmk_split_wired_position_state state;
+    memcpy(state.position_state, position_state, sizeof(position_state));
+
+    return zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_POSITION_STATE, &state, sizeof(state));
+}
+
+static void resend_position_state_callback(struct k_work *work);
+
+K_WORK_DELAYABLE_DEFINE(resend_position_state_work, resend_position_state_callback);
+
+static void schedule_position_state_resend(void) {
+    // Retry once the UART has had time to send a frame's worth of the queued bytes.
+    k_work_schedule(&resend_position_state_work,
+                    K_USEC(zmk_split_wired_frame_time_us(
+                        sizeof(struct zmk_split_wired_position_state))));
+}
+
+static void resend_position_state_callback(struct k_work *work) {
+    if (send_position_state() != 0) {
+        schedule_position_state_resend();
+    }
+}
+
+static int send_position_event(uint8_t position, bool pressed, int64_t timestamp) {
+    WRITE_BIT(position_state[position / 8], position % 8, pressed);
+
+    struct zmk_split_wired_position_event ev = {
+        .position = position,
+        .state = pressed ? 1 : 0,
+        .age = MIN(k_uptime_get() - timestamp, UINT16_MAX),
+    };
+
+    int err = zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_POSITION_EVENT, &ev, sizeof(ev));
+    if (err) {
+        // The central never sees the dropped change, which would leave a key stuck if it was a
+        // release, so send the full state instead once there is room.
+        LOG_WRN("Dropped position %d %s, resending the position state", position,
+                pressed ? "press" : "release");
+        schedule_position_state_resend();
+    }
+
+    return err;
+}
+
+int zmk_split_position_pressed(uint8_t position, int64_t timestamp) {
+    return send_position_event(position, true, timestamp);
+}
+
+int zmk_split_position_released(uint8_t position, int64_t timestamp) {
+    return send_position_event(position, false, timestamp);
+}
+
+#if ZMK_KEYMAP_HAS_SENSORS
+
+struct pending_sensor_delta {
+    int32_t delta;
+    int64_t since;
+};
+
+static struct k_spinlock sensor_lock;
+static struct pending_sensor_delta sensor_deltas[ZMK_KEYMAP_SENSORS_LEN];
+
+static void send_sensor_events_callback(struct k_work *work) {
+    for (int i = 0; i < ZMK_KEYMAP_SENSORS_LEN; i++) {
+        k_spinlock_key_t key = k_spin_lock(&sensor_lock);
+        struct pending_sensor_delta pending = sensor_deltas[i];
+        int16_t delta = CLAMP(pending.delta, INT16_MIN, INT16_MAX);
+        sensor_deltas[i].delta -= delta;
+        k_spin_unlock(&sensor_lock, key);
+
+        if (delta == 0) {
+            continue;
+        }
+
+        struct zmk_split_wired_sensor_event ev = {
+            .sensor_number = i,
+            .delta = delta,
+            .age = MIN(k_uptime_get() - pending.since, UINT16_MAX),
+        };
+
+        zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_SENSOR_EVENT, &ev, sizeof(ev));
+    }
+}
+
+K_WORK_DEFINE(send_sensor_events_work, send_sensor_events_callback);
+
+int zmk_split_sensor_triggered(uint8_t sensor_number, int32_t delta, int64_t timestamp) {
+    if (sensor_number >= ZMK_KEYMAP_SENSORS_LEN) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&sensor_lock);
+    if (sensor_deltas[sensor_number].delta == 0) {
+        sensor_deltas[sensor_number].since = timestamp;
+    }
+    sensor_deltas[sensor_number].delta += delta;
+    k_spin_unlock(&sensor_lock, key);
+
+    // Ticks arriving before the work runs are sent as one accumulated event.
+    k_work_submit(&send_sensor_events_work);
+
+    return 0;
+}
+
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
+static void run_behavior(char *behavior_dev, const struct zmk_split_wired_run_behavior_data *data) {
+    struct zmk_behavior_binding binding = {
+        .param1 = data->param1,
+        .param2 = data->param2,
+        .behavior_dev = behavior_dev,
+    };
+    LOG_DBG("%s with params %d %d: pressed? %d", log_strdup(binding.behavior_dev), binding.param1,
+            binding.param2, data->state);
+    struct zmk_behavior_binding_event event = {.position = data->position,
+                                               .timestamp = k_uptime_get()};
+    int err;
+    if (data->state > 0) {
+        err = behavior_keymap_binding_pressed(&binding, event);
+    } else {
+        err = behavior_keymap_binding_released(&binding, event);
+    }
+
+    if (err) {
+        LOG_ERR("Failed to invoke behavior %s: %d", log_strdup(binding.behavior_dev), err);
+    }
+}
+
+static void handle_run_behavior(const uint8_t *payload, uint8_t len) {
+    const struct zmk_split_wired_run_behavior *run =
+        (const struct zmk_split_wired_run_behavior *)payload;
+    char behavior_dev[ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN + 1];
+    size_t label_len = len - sizeof(*run);
+
+    if (len <= sizeof(*run)) {
+        LOG_ERR("Invalid run behavior message");
+        return;
+    }
+
+    memcpy(behavior_dev, run->behavior_dev, label_len);
+    behavior_dev[label_len] = '\0';
+
+    run_behavior(behavior_dev, &run->data);
+}
+
+static void handle_run_behavior_id(const uint8_t *payload, uint8_t len) {
+    const struct zmk_split_wired_run_behavior_id *run =
+        (const struct zmk_split_wired_run_behavior_id *)payload;
+
+    if (len != sizeof(*run)) {
+        LOG_ERR("Invalid run behavior id message");
+        return;
+    }
+
+    const char *label = zmk_split_behavior_label_for_id(run->behavior_id);
+    if (label == NULL || zmk_split_behavior_label_check(label) != run->behavior_label_check) {
+        LOG_ERR("Unknown behavior id %d, are both halves built from the same keymap?",
+                run->behavior_id);
+        return;
+    }
+
+    run_behavior((char *)label, &run->data);
+}
+
+void zmk_split_wired_message_received(enum zmk_split_wired_msg_type type, const uint8_t *payload,
+                                      uint8_t len, int64_t timestamp) {
+    switch (type) {
+    case ZMK_SPLIT_WIRED_MSG_SYNC_REQUEST:
+        send_position_state();
+        break;
+    case ZMK_SPLIT_WIRED_MSG_RUN_BEHAVIOR:
+        handle_run_behavior(payload, len);
+        break;
+    case ZMK_SPLIT_WIRED_MSG_RUN_BEHAVIOR_ID:
+        handle_run_behavior_id(payload, len);
+        break;
+    default:
+        LOG_WRN("Unexpected split message type 0x%02x", type);
+        break;
+    }
+}
+
+void zmk_split_wired_frame_dropped(void) {}
+
+// Lets the central release any keys it still thinks are held if we were reset.
+void zmk_split_wired_ready(void) { send_position_state(); }
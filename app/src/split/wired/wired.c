@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2022 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <device.h>
+#include <devicetree.h>
+#include <init.h>
+#include <kernel.h>
+#include <string.h>
+#include <drivers/uart.h>
+#include <sys/crc.h>
+#include <sys/ring_buffer.h>
+
+#include <logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/split/wired/wired.h>
+
+#define SPLIT_UART_NODE DT_CHOSEN(zmk_split_uart)
+#define SPLIT_UART_BAUD DT_PROP_OR(SPLIT_UART_NODE, current_speed, 115200)
+
+#define FRAME_SOF 0xA5
+// Start byte, type, length and two CRC bytes
+#define FRAME_OVERHEAD 5
+
+enum rx_state {
+    RX_STATE_SOF,
+    RX_STATE_TYPE,
+    RX_STATE_LEN,
+    RX_STATE_PAYLOAD,
+    RX_STATE_CRC_LOW,
+    RX_STATE_CRC_HIGH,
+};
+
+struct rx_frame {
+    enum rx_state state;
+    uint8_t type;
+    uint8_t len;
+    uint8_t received;
+    uint16_t crc;
+    uint8_t payload[ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN];
+};
+
+static const struct device *uart = DEVICE_DT_GET(SPLIT_UART_NODE);
+
+static struct rx_frame rx_frame;
+
+static uint32_t rx_frame_count;
+static uint32_t rx_error_count;
+
+uint32_t zmk_split_wired_frame_time_us(uint8_t len) {
+    // 8N1 framing puts 10 bits on the wire per byte.
+    return ((len + FRAME_OVERHEAD) * 10U * USEC_PER_SEC) / SPLIT_UART_BAUD;
+}
+
+static uint16_t frame_crc(uint8_t type, uint8_t len, const uint8_t *payload) {
+    uint8_t header[] = {type, len};
+    uint16_t crc = crc16_ccitt(0xFFFF, header, sizeof(header));
+    return crc16_ccitt(crc, payload, len);
+}
+
+static void rx_frame_error(void) {
+    rx_error_count++;
+    LOG_WRN("Dropped corrupt split frame (%d errors in %d frames)", rx_error_count,
+            rx_frame_count);
+    rx_frame.state = RX_STATE_SOF;
+    zmk_split_wired_frame_dropped();
+}
+
+// `timestamp` is the uptime at which the byte was received.
+static void process_rx_byte(uint8_t byte, int64_t timestamp) {
+    switch (rx_frame.state) {
+    case RX_STATE_SOF:
+        if (byte == FRAME_SOF) {
+            rx_frame.state = RX_STATE_TYPE;
+        }
+        break;
+    case RX_STATE_TYPE:
+        rx_frame.type = byte;
+        rx_frame.state = RX_STATE_LEN;
+        break;
+    case RX_STATE_LEN:
+        if (byte > ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN) {
+            rx_frame_error();
+            break;
+        }
+        rx_frame.len = byte;
+        rx_frame.received = 0;
+        rx_frame.state = byte > 0 ? RX_STATE_PAYLOAD : RX_STATE_CRC_LOW;
+        break;
+    case RX_STATE_PAYLOAD:
+        rx_frame.payload[rx_frame.received++] = byte;
+        if (rx_frame.received == rx_frame.len) {
+            rx_frame.state = RX_STATE_CRC_LOW;
+        }
+        break;
+    case RX_STATE_CRC_LOW:
+        rx_frame.crc = byte;
+        rx_frame.state = RX_STATE_CRC_HIGH;
+        break;
+    case RX_STATE_CRC_HIGH:
+        rx_frame.crc |= byte << 8;
+        if (rx_frame.crc != frame_crc(rx_frame.type, rx_frame.len, rx_frame.payload)) {
+            rx_frame_error();
+            break;
+        }
+
+        rx_frame_count++;
+        rx_frame.state = RX_STATE_SOF;
+        zmk_split_wired_message_received(rx_frame.type, rx_frame.payload, rx_frame.len, timestamp);
+        break;
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_IRQ)
+
+// Bytes read by one pass of the ISR, which all arrived at about the same time.
+struct rx_batch {
+    int64_t timestamp;
+    uint16_t len;
+};
+
+RING_BUF_DECLARE(rx_buf, CONFIG_ZMK_SPLIT_WIRED_RX_BUFFER_SIZE);
+RING_BUF_DECLARE(tx_buf, CONFIG_ZMK_SPLIT_WIRED_TX_BUFFER_SIZE);
+
+// Each batch holds at least one byte, but the ISR usually reads several at once.
+K_MSGQ_DEFINE(rx_batch_msgq, sizeof(struct rx_batch),
+              MAX(CONFIG_ZMK_SPLIT_WIRED_RX_BUFFER_SIZE / 4, 1), 4);
+
+static struct k_spinlock tx_lock;
+
+static void rx_work_callback(struct k_work *work) {
+    struct rx_batch batch;
+
+    // Bytes are added to the ring buffer before their batch is queued, so every batch's bytes are
+    // already there. Frames take the time of the batch holding their last byte.
+    while (k_msgq_get(&rx_batch_msgq, &batch, K_NO_WAIT) == 0) {
+        for (int i = 0; i < batch.len; i++) {
+            uint8_t byte;
+
+            ring_buf_get(&rx_buf, &byte, sizeof(byte));
+            process_rx_byte(byte, batch.timestamp);
+        }
+    }
+}
+
+K_WORK_DEFINE(rx_work, rx_work_callback);
+
+static void uart_isr(const struct device *dev, void *user_data) {
+    while (uart_irq_update(dev) && uart_irq_is_pending(dev)) {
+        if (uart_irq_rx_ready(dev)) {
+            const int64_t timestamp = k_uptime_get();
+            uint8_t *data;
+            uint32_t space =
+                (k_msgq_num_free_get(&rx_batch_msgq) > 0)
+                    ? ring_buf_put_claim(&rx_buf, &data, CONFIG_ZMK_SPLIT_WIRED_RX_BUFFER_SIZE)
+                    : 0;
+            int read = 0;
+
+            if (space > 0) {
+                read = uart_fifo_read(dev, data, space);
+                ring_buf_put_finish(&rx_buf, MAX(read, 0));
+
+                if (read > 0) {
+                    struct rx_batch batch = {.timestamp = timestamp, .len = read};
+                    k_msgq_put(&rx_batch_msgq, &batch, K_NO_WAIT);
+                }
+            } else {
+                // Out of room, so drop the byte and let the CRC check discard its frame.
+                uint8_t discarded;
+                read = uart_fifo_read(dev, &discarded, sizeof(discarded));
+            }
+
+            if (read > 0) {
+                k_work_submit(&rx_work);
+            }
+        }
+
+        if (uart_irq_tx_ready(dev)) {
+            uint8_t *data;
+            uint32_t len =
+                ring_buf_get_claim(&tx_buf, &data, CONFIG_ZMK_SPLIT_WIRED_TX_BUFFER_SIZE);
+
+            if (len == 0) {
+                uart_irq_tx_disable(dev);
+            } else {
+                int sent = uart_fifo_fill(dev, data, len);
+                ring_buf_get_finish(&tx_buf, MAX(sent, 0));
+            }
+        }
+    }
+}
+
+static int write_frame(const uint8_t *frame, size_t len) {
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+    if (ring_buf_space_get(&tx_buf) < len) {
+        k_spin_unlock(&tx_lock, key);
+        return -ENOMEM;
+    }
+
+    ring_buf_put(&tx_buf, frame, len);
+    k_spin_unlock(&tx_lock, key);
+
+    uart_irq_tx_enable(uart);
+
+    return 0;
+}
+
+static int start_uart(void) {
+    uart_irq_callback_user_data_set(uart, uart_isr, NULL);
+    uart_irq_rx_enable(uart);
+
+    return 0;
+}
+
+#else /* IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_IRQ) */
+
+K_MUTEX_DEFINE(tx_mutex);
+
+static void rx_poll_work_callback(struct k_work *work);
+
+K_WORK_DELAYABLE_DEFINE(rx_poll_work, rx_poll_work_callback);
+
+static void rx_poll_work_callback(struct k_work *work) {
+    // Bytes waiting for this poll arrived at some point since the last one, so use the time of
+    // the poll for all of them.
+    const int64_t timestamp = k_uptime_get();
+    unsigned char byte;
+
+    while (uart_poll_in(uart, &byte) == 0) {
+        process_rx_byte(byte, timestamp);
+    }
+
+    k_work_schedule(&rx_poll_work, K_MSEC(CONFIG_ZMK_SPLIT_WIRED_POLL_INTERVAL_MS));
+}
+
+static int write_frame(const uint8_t *frame, size_t len) {
+    k_mutex_lock(&tx_mutex, K_FOREVER);
+
+    for (int i = 0; i < len; i++) {
+        uart_poll_out(uart, frame[i]);
+    }
+
+    k_mutex_unlock(&tx_mutex);
+
+    return 0;
+}
+
+static int start_uart(void) {
+    k_work_schedule(&rx_poll_work, K_NO_WAIT);
+
+    return 0;
+}
+
+#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_IRQ) */
+
+int zmk_split_wired_send(enum zmk_split_wired_msg_type type, const void *payload, uint8_t len) {
+    uint8_t frame[ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN + FRAME_OVERHEAD];
+
+    if (len > ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN) {
+        return -EINVAL;
+    }
+
+    uint16_t crc = frame_crc(type, len, payload);
+
+    frame[0] = FRAME_SOF;
+    frame[1] = type;
+    frame[2] = len;
+    if (len > 0) {
+        memcpy(&frame[3], payload, len);
+    }
+    frame[3 + len] = crc & 0xFF;
+    frame[4 + len] = crc >> 8;
+
+    int err = write_frame(frame, len + FRAME_OVERHEAD);
+    if (err) {
+        LOG_ERR("Failed to queue split frame of type 0x%02x (err %d)", type, err);
+    }
+
+    return err;
+}
+
+static int zmk_split_wired_init(const struct device *_arg) {
+    if (!device_is_ready(uart)) {
+        LOG_ERR("Split UART device is not ready");
+        return -ENODEV;
+    }
+
+    int err = start_uart();
+    if (err) {
+        return err;
+    }
+
+    zmk_split_wired_ready();
+
+    return 0;
+}
+
+SYS_INIT(zmk_split_wired_init, APPLICATION, CONFIG_ZMK_SPLIT_WIRED_INIT_PRIORITY);
@@ -7,6 +7,8 @@
 #include <device.h>
 #include <init.h>
 #include <kernel.h>
+#include <string.h>
+#include <sys/atomic.h>
 
 #include <logging/log.h>
 
@@ -15,72 +17,115 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/event_manager.h>
 #include <zmk/events/wpm_state_changed.h>
 #include <zmk/events/keycode_state_changed.h>
+#include <zmk/events/activity_state_changed.h>
 
+#include <zmk/activity.h>
 #include <zmk/wpm.h>
 
 #define WPM_UPDATE_INTERVAL_SECONDS 1
-#define WPM_RESET_INTERVAL_SECONDS 5
+// Number of update intervals in the moving average.
+#define WPM_WINDOW_INTERVALS 5
 
 // See https://en.wikipedia.org/wiki/Words_per_minute
 // "Since the length or duration of words is clearly variable, for the purpose of measurement of
 // text entry, the definition of each "word" is often standardized to be five characters or
 // keystrokes long in English"
-#define CHARS_PER_WORD 5.0
+#define CHARS_PER_WORD 5
+
+#define WPM_MAX UINT8_MAX
 
 static uint8_t wpm_state = -1;
 static uint8_t last_wpm_state;
-static uint8_t wpm_update_counter;
-static uint32_t key_pressed_count;
 
-int zmk_wpm_get_state() { return wpm_state; }
+// Keys released since the last update. Keycode events may be raised from any thread.
+static atomic_t key_pressed_count;
 
-int wpm_event_listener(const zmk_event_t *eh) {
-    const struct zmk_keycode_state_changed *ev = as_zmk_keycode_state_changed(eh);
-    if (ev) {
-        // count only key up events
-        if (!ev->state) {
-            key_pressed_count++;
-            LOG_DBG("key_pressed_count %d keycode %d", key_pressed_count, ev->keycode);
-        }
-    }
-    return 0;
-}
+// Keys released in each of the last WPM_WINDOW_INTERVALS updates, and their sum. Only used from the
+// system work queue.
+static uint16_t key_counts[WPM_WINDOW_INTERVALS];
+static uint32_t key_counts_total;
+static uint8_t key_counts_index;
 
-void wpm_work_handler(struct k_work *work) {
-    wpm_update_counter++;
-    wpm_state = (key_pressed_count / CHARS_PER_WORD) /
-                (wpm_update_counter * WPM_UPDATE_INTERVAL_SECONDS / 60.0);
+int zmk_wpm_get_state() { return wpm_state; }
 
+static void wpm_raise_state(void) {
     if (last_wpm_state != wpm_state) {
-        LOG_DBG("Raised WPM state changed %d wpm_update_counter %d", wpm_state, wpm_update_counter);
+        LOG_DBG("Raised WPM state changed %d", wpm_state);
 
         ZMK_EVENT_RAISE(
             new_zmk_wpm_state_changed((struct zmk_wpm_state_changed){.state = wpm_state}));
 
         last_wpm_state = wpm_state;
     }
+}
+
+static void wpm_work_handler(struct k_work *work);
+
+K_WORK_DELAYABLE_DEFINE(wpm_work, wpm_work_handler);
+
+static void wpm_work_handler(struct k_work *work) {
+    const uint16_t count = MIN(atomic_clear(&key_pressed_count), UINT16_MAX);
+
+    key_counts_total -= key_counts[key_counts_index];
+    key_counts[key_counts_index] = count;
+    key_counts_total += count;
+    key_counts_index = (key_counts_index + 1) % WPM_WINDOW_INTERVALS;
+
+    wpm_state = MIN(key_counts_total * 60 /
+                        (CHARS_PER_WORD * WPM_WINDOW_INTERVALS * WPM_UPDATE_INTERVAL_SECONDS),
+                    WPM_MAX);
+    wpm_raise_state();
 
-    if (wpm_update_counter >= WPM_RESET_INTERVAL_SECONDS) {
-        wpm_update_counter = 0;
-        key_pressed_count = 0;
+    // Once the whole window is empty the state stays at zero, so stop updating until the next key.
+    // A key released since the count was taken has already rescheduled the work.
+    if (key_counts_total > 0) {
+        k_work_schedule(&wpm_work, K_SECONDS(WPM_UPDATE_INTERVAL_SECONDS));
     }
 }
 
-K_WORK_DEFINE(wpm_work, wpm_work_handler);
+static void wpm_reset(void) {
+    LOG_DBG("Resetting WPM while inactive");
 
-void wpm_expiry_function() { k_work_submit(&wpm_work); }
+    k_work_cancel_delayable(&wpm_work);
+    atomic_clear(&key_pressed_count);
 
-K_TIMER_DEFINE(wpm_timer, wpm_expiry_function, NULL);
+    memset(key_counts, 0, sizeof(key_counts));
+    key_counts_total = 0;
+
+    wpm_state = 0;
+    wpm_raise_state();
+}
+
+int wpm_event_listener(const zmk_event_t *eh) {
+    const struct zmk_keycode_state_changed *ev = as_zmk_keycode_state_changed(eh);
+    if (ev) {
+        // count only key up events
+        if (!ev->state) {
+            atomic_inc(&key_pressed_count);
+            LOG_DBG("key_pressed_count %d keycode %d", (int)atomic_get(&key_pressed_count),
+                    ev->keycode);
+
+            // Does nothing if the update is already scheduled.
+            k_work_schedule(&wpm_work, K_SECONDS(WPM_UPDATE_INTERVAL_SECONDS));
+        }
+        return 0;
+    }
+
+    // Activity state changes are raised from the system work queue, like the updates.
+    if (as_zmk_activity_state_changed(eh) && zmk_activity_get_state() != ZMK_ACTIVITY_ACTIVE) {
+        wpm_reset();
+    }
+
+    return 0;
+}
 
 int wpm_init() {
     wpm_state = 0;
-    wpm_update_counter = 0;
-    k_timer_start(&wpm_timer, K_SECONDS(WPM_UPDATE_INTERVAL_SECONDS),
-                  K_SECONDS(WPM_UPDATE_INTERVAL_SECONDS));
     return 0;
 }
 
 ZMK_LISTENER(wpm, wpm_event_listener);
 ZMK_SUBSCRIPTION(wpm, zmk_keycode_state_changed);
+ZMK_SUBSCRIPTION(wpm, zmk_activity_state_changed);
 
 SYS_INIT(wpm_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);